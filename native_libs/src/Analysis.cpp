@@ -1,6 +1,7 @@
 #include "Analysis.h"
 
 #include "Processing.h"
+#include "Sort.h"
 
 #include <unordered_map>
 
@@ -49,7 +50,7 @@ std::shared_ptr<arrow::Table> countValueTyped(const arrow::Column &column)
         [&] (auto &&elem) { valueCounts[elem]++; },
         [] () {});
 
-    auto valueBuilder = makeBuilder(std::static_pointer_cast<ArrowType>(column.field()->type()));
+    auto valueBuilder = makeBuilder(std::static_pointer_cast<ArrowType>(valueType(column.field()->type())));
     arrow::Int64Builder countBuilder;
 
     valueBuilder->Reserve(valueCounts.size());
@@ -671,13 +672,14 @@ DFH_EXPORT std::shared_ptr<arrow::Table> abominableGroupAggregate(std::shared_pt
                     append(*builder, keyValues[group]);
 
                 auto arr = finish(*builder);
-                newColumns.push_back(std::make_shared<arrow::Column>(keyColumn->field(), arr));
+                const auto keyField = arrow::field(keyColumn->name(), arr->type(), keyColumn->field()->nullable()); // dictionary-encoded keys are decoded
+                newColumns.push_back(std::make_shared<arrow::Column>(keyField, arr));
             }
 
             // build column for each (column, aggregate function) pair
             for(auto &colAggrs : toAggregate)
             {
-                visitType(colAggrs.first->type()->id(), [&](auto id)
+                visitType(*colAggrs.first->type(), [&](auto id)
                 {
                     auto [column, aggregates] = colAggrs;
                     using T = typename TypeDescription<id.value>::ObservedType;
@@ -856,6 +858,10 @@ std::optional<double> calculateFunctionOnWindow(const Indexable &indexable, int6
 
 std::vector<int64_t> collectRollingIntervalSizes(std::shared_ptr<arrow::Column> keyColumn, DynamicField interval)
 {
+    // windows are found by moving along the keys, which would give wrong results for unordered ones
+    if(!columnOrder(*keyColumn).nonDecreasing)
+        THROW("rolling interval key column `{}` must be sorted in ascending order", keyColumn->name());
+
     try
     {
         return dispatchIndexable(keyColumn, [&] (auto &&indexable)
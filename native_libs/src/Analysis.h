@@ -37,6 +37,9 @@ struct GroupedKeyInfo
         : hasNulls(keyColumn.null_count() != 0)
         , groupIds(keyColumn.length())
     {
+        if(keyColumn.type()->id() == arrow::Type::DICTIONARY)
+            return groupByDictionaryCodes(keyColumn);
+
         auto *rowGroupId = groupIds.data();
         iterateOver<ArrowType::type_id>(keyColumn, 
             [&] (auto &&value)
@@ -56,6 +59,38 @@ struct GroupedKeyInfo
             });
     }
 
+    // Each distinct code is hashed only once, rows are then assigned groups by their codes.
+    // All chunks share the dictionary, as it is a part of the column type.
+    void groupByDictionaryCodes(const arrow::Column &keyColumn)
+    {
+        const auto dictionary = static_cast<const arrow::DictionaryType &>(*keyColumn.type()).dictionary();
+        std::vector<int64_t> codeGroupIds(dictionary->length(), -1); // [code] => group id
+        auto *rowGroupId = groupIds.data();
+        for(auto &chunk : keyColumn.data()->chunks())
+        {
+            const auto &array = static_cast<const arrow::DictionaryArray &>(*chunk);
+            visitDictionaryCodes(array, [&] (auto *codes)
+            {
+                for(int64_t row = 0; row < array.length(); row++)
+                {
+                    if(array.IsNull(row))
+                    {
+                        *rowGroupId++ = 0;
+                        continue;
+                    }
+
+                    auto &groupId = codeGroupIds[codes[row]];
+                    if(groupId < 0)
+                    {
+                        const auto value = arrayValueAt<ArrowType::type_id>(*dictionary, (int32_t)codes[row]);
+                        groupId = uniqueValues.emplace(value, uniqueValues.size() + 1).first->second;
+                    }
+                    *rowGroupId++ = groupId;
+                }
+            });
+        }
+    }
+
     int64_t groupCount() const
     {
         // Null is not included in unique values
@@ -132,6 +132,40 @@ std::shared_ptr<arrow::Table> tableFromColumns(const std::vector<std::shared_ptr
     return arrow::Table::Make(schema, tableColumns);
 }
 
+std::shared_ptr<arrow::Table> concatenateTables(const std::vector<std::shared_ptr<arrow::Table>> &tables)
+{
+    if(tables.empty())
+        THROW("cannot concatenate an empty list of tables");
+
+    const auto &schema = *tables.front()->schema();
+    std::vector<std::shared_ptr<arrow::Column>> columns;
+    for(int column = 0; column < schema.num_fields(); column++)
+    {
+        const auto &firstField = *schema.field(column);
+        bool nullable = false;
+        arrow::ArrayVector chunks;
+        for(auto &&table : tables)
+        {
+            if(table->num_columns() != schema.num_fields())
+                THROW("cannot concatenate tables with {} and {} columns", schema.num_fields(), table->num_columns());
+
+            const auto &field = *table->schema()->field(column);
+            if(field.name() != firstField.name() || !field.type()->Equals(firstField.type()))
+                THROW("cannot concatenate tables: column #{} is {} `{}` in one table and {} `{}` in another", column,
+                    firstField.type()->ToString(), firstField.name(), field.type()->ToString(), field.name());
+
+            nullable = nullable || field.nullable();
+            const auto &tableChunks = table->column(column)->data()->chunks();
+            chunks.insert(chunks.end(), tableChunks.begin(), tableChunks.end());
+        }
+
+        const auto field = arrow::field(firstField.name(), firstField.type(), nullable);
+        columns.push_back(std::make_shared<arrow::Column>(field, std::make_shared<arrow::ChunkedArray>(chunks, firstField.type())));
+    }
+
+    return tableFromColumns(columns);
+}
+
 std::shared_ptr<arrow::Table> replaceColumn(const arrow::Table &table, const arrow::Column &columnToBeReplaced, std::shared_ptr<arrow::Column> replaceWith)
 {
     std::vector<std::shared_ptr<arrow::Column>> ret;
@@ -172,10 +206,10 @@ DynamicJustVector toJustVector(const arrow::Column &column)
 
 DynamicField arrayAt(const arrow::Array &array, int32_t index)
 {
-    return visitArray(array, [&](auto *array) -> DynamicField
+    return visitType(*array.type(), [&](auto id) -> DynamicField
     {
-        if(array->IsValid(index))
-            return arrayValueAtTyped(*array, index);
+        if(array.IsValid(index))
+            return arrayValueAt<id.value>(array, index);
         else
             return std::nullopt;
     });
@@ -246,6 +280,19 @@ using GetType = typename GetTypeS<std::decay_t<SharedPtrToType>>::type;
 
 std::shared_ptr<arrow::Array> makeNullsArray(TypePtr type, int64_t length)
 {
+    if(type->id() == arrow::Type::DICTIONARY)
+    {
+        // all codes are null, so their values don't matter
+        const auto &indexType = static_cast<const arrow::DictionaryType &>(*type).index_type();
+        const auto indexWidth = static_cast<const arrow::FixedWidthType &>(*indexType).bit_width() / 8;
+        const auto [values, valuesData] = allocateBuffer<uint8_t>(length * indexWidth);
+        const auto [bitmap, bitmapData] = allocateBuffer<uint8_t>(arrow::BitUtil::BytesForBits(length));
+        std::memset(valuesData, 0, length * indexWidth);
+        std::memset(bitmapData, 0, arrow::BitUtil::BytesForBits(length));
+        const auto indices = arrow::MakeArray(arrow::ArrayData::Make(indexType, length, { bitmap, values }, length));
+        return std::make_shared<arrow::DictionaryArray>(type, indices);
+    }
+
     return visitDataType(type, [&](auto &&typeDer)
     {
         using Type = GetType<decltype(typeDer)>;
@@ -337,7 +384,8 @@ Timestamp::Timestamp(date::year_month_day ymd)
 
 std::shared_ptr<arrow::Column> consolidate(std::shared_ptr<arrow::Column> column)
 {
-    if(column->data()->num_chunks() <= 1)
+    const auto isDictionary = column->type()->id() == arrow::Type::DICTIONARY;
+    if(column->data()->num_chunks() <= 1 && !isDictionary)
         return column;
 
     return visitType(*column->type(), [&](auto id)
@@ -346,7 +394,7 @@ std::shared_ptr<arrow::Column> consolidate(std::shared_ptr<arrow::Column> column
         using ArrowT = typename TD::ArrowType;
         using Builder = typename TD::BuilderType;
 
-        auto builder = makeBuilder(std::dynamic_pointer_cast<ArrowT>(column->type()));
+        auto builder = makeBuilder(std::dynamic_pointer_cast<ArrowT>(valueType(column->type())));
         iterateOver<id.value>(*column, [&](auto &&elem)
         {
             append(*builder, elem);
@@ -357,6 +405,104 @@ std::shared_ptr<arrow::Column> consolidate(std::shared_ptr<arrow::Column> column
         });
 
         auto arr = finish(*builder);
-        return std::make_shared<arrow::Column>(column->field(), arr);
+        const auto field = isDictionary ? arrow::field(column->name(), arr->type(), column->field()->nullable()) : column->field();
+        return std::make_shared<arrow::Column>(field, arr);
+    });
+}
+
+std::shared_ptr<arrow::Array> decodeDictionary(std::shared_ptr<arrow::Array> array)
+{
+    if(array->type_id() != arrow::Type::DICTIONARY)
+        return array;
+
+    return visitType(*array->type(), [&](auto id)
+    {
+        using ArrowT = typename TypeDescription<id.value>::ArrowType;
+
+        auto builder = makeBuilder(std::static_pointer_cast<ArrowT>(dictionaryValueType(*array->type())));
+        checkStatus(builder->Reserve(array->length()));
+        iterateOver<id.value>(*array, 
+            [&] (auto &&elem) { checkStatus(append(*builder, elem)); },
+            [&] { checkStatus(builder->AppendNull()); });
+        return finish(*builder);
+    });
+}
+
+std::shared_ptr<arrow::Column> decodeDictionary(std::shared_ptr<arrow::Column> column)
+{
+    if(column->type()->id() != arrow::Type::DICTIONARY)
+        return column;
+
+    const auto chunks = transformToVector(column->data()->chunks(), [] (auto &&chunk) { return decodeDictionary(chunk); });
+    const auto field = arrow::field(column->name(), dictionaryValueType(*column->type()), column->field()->nullable());
+    return std::make_shared<arrow::Column>(field, chunks);
+}
+
+std::shared_ptr<arrow::Column> dictionaryIndices(const arrow::Column &column)
+{
+    const auto chunks = transformToVector(column.data()->chunks(), [] (auto &&chunk)
+    {
+        return static_cast<const arrow::DictionaryArray &>(*chunk).indices();
     });
+    const auto &indexType = static_cast<const arrow::DictionaryType &>(*column.type()).index_type();
+    return std::make_shared<arrow::Column>(arrow::field(column.name(), indexType, column.field()->nullable()), chunks);
+}
+
+std::shared_ptr<arrow::Column> withDictionaryIndices(std::shared_ptr<arrow::Field> field, const arrow::Column &indices)
+{
+    const auto chunks = transformToVector(indices.data()->chunks(), [&] (auto &&chunk) -> std::shared_ptr<arrow::Array>
+    {
+        return std::make_shared<arrow::DictionaryArray>(field->type(), chunk);
+    });
+    return std::make_shared<arrow::Column>(field, chunks);
+}
+
+std::vector<std::shared_ptr<arrow::Array>> unifyDictionaries(const std::vector<std::shared_ptr<arrow::Array>> &arrays)
+{
+    if(arrays.size() <= 1)
+        return arrays;
+
+    // Collect the distinct values of all dictionaries, remembering how each code should be translated.
+    arrow::StringBuilder dictionaryBuilder;
+    std::unordered_map<std::string_view, int32_t> codes; // views refer to the input dictionaries, that are kept alive by `arrays`
+    std::vector<std::vector<int32_t>> newCodes; // [array][old code] => code in the unified dictionary
+    for(auto &array : arrays)
+    {
+        if(array->type_id() != arrow::Type::DICTIONARY || dictionaryValueType(*array->type())->id() != arrow::Type::STRING)
+            THROW("cannot unify dictionaries: expected dictionary-encoded strings, got {}", array->type()->ToString());
+
+        const auto dictionary = static_cast<const arrow::DictionaryArray &>(*array).dictionary();
+        const auto &values = static_cast<const arrow::StringArray &>(*dictionary);
+        auto &mapping = newCodes.emplace_back();
+        mapping.reserve(values.length());
+        for(int32_t i = 0; i < values.length(); i++)
+        {
+            const auto value = arrayValueAtTyped(values, i);
+            const auto [itr, inserted] = codes.try_emplace(value, (int32_t)codes.size());
+            if(inserted)
+                checkStatus(append(dictionaryBuilder, value));
+            mapping.push_back(itr->second);
+        }
+    }
+
+    const auto type = arrow::dictionary(arrow::int32(), finish(dictionaryBuilder));
+    std::vector<std::shared_ptr<arrow::Array>> ret;
+    for(size_t i = 0; i < arrays.size(); i++)
+    {
+        const auto &array = static_cast<const arrow::DictionaryArray &>(*arrays[i]);
+        const auto &mapping = newCodes[i];
+        const auto indices = array.indices();
+        const auto length = array.length();
+        const auto offset = indices->offset(); // shared with the null bitmap that is reused
+        const auto [buffer, output] = allocateBuffer<int32_t>(offset + length);
+        visitDictionaryCodes(array, [&] (auto *inputCodes)
+        {
+            for(int64_t row = 0; row < length; row++)
+                output[offset + row] = array.IsValid(row) ? mapping[inputCodes[row]] : 0;
+        });
+
+        const auto newIndices = arrow::MakeArray(arrow::ArrayData::Make(arrow::int32(), length, { indices->null_bitmap(), buffer }, indices->null_count(), offset));
+        ret.push_back(std::make_shared<arrow::DictionaryArray>(type, newIndices));
+    }
+    return ret;
 }
@@ -191,6 +191,18 @@ constexpr arrow::Type::type getID(const std::shared_ptr<T> &)
     return T::type_id;
 }
 
+// Dictionary-encoded arrays hold values of their dictionary type, visitors below dispatch on that type.
+inline TypePtr dictionaryValueType(const arrow::DataType &type)
+{
+    return static_cast<const arrow::DictionaryType &>(type).dictionary()->type();
+}
+
+// For dictionary types returns the type of dictionary values, otherwise the type itself.
+inline TypePtr valueType(const TypePtr &type)
+{
+    return type->id() == arrow::Type::DICTIONARY ? dictionaryValueType(*type) : type;
+}
+
 template<typename F>
 auto visitDataType3(const std::shared_ptr<arrow::DataType> &type, F &&f)
 {
@@ -200,6 +212,7 @@ auto visitDataType3(const std::shared_ptr<arrow::DataType> &type, F &&f)
         case arrow::Type::DOUBLE: return f(std::static_pointer_cast<arrow::DoubleType>(type));
         case arrow::Type::STRING: return f(std::static_pointer_cast<arrow::StringType>(type));
         case arrow::Type::TIMESTAMP: return f(std::static_pointer_cast<arrow::TimestampType>(type));
+        case arrow::Type::DICTIONARY: return visitDataType3(dictionaryValueType(*type), f);
         default: throw std::runtime_error("type not supported to downcast: " + type->ToString());
     }
 }
@@ -214,6 +227,7 @@ auto visitDataType(const std::shared_ptr<arrow::DataType> &type, F &&f)
     case arrow::Type::STRING: return f(std::static_pointer_cast<arrow::StringType>(type));
     case arrow::Type::TIMESTAMP: return f(std::static_pointer_cast<arrow::TimestampType>(type));
     case arrow::Type::LIST: return f(std::static_pointer_cast<arrow::ListType>(type));
+    case arrow::Type::DICTIONARY: return visitDataType(dictionaryValueType(*type), f);
     default: throw std::runtime_error("type not supported to downcast: " + type->ToString());
     }
 }
@@ -242,6 +256,7 @@ auto visitType(const arrow::DataType &type, F &&f)
     case arrow::Type::STRING: return f(std::integral_constant<arrow::Type::type, arrow::Type::STRING>{});
     case arrow::Type::TIMESTAMP: return f(std::integral_constant<arrow::Type::type, arrow::Type::TIMESTAMP>{});
     //case arrow::Type::LIST: return f(std::integral_constant<arrow::Type::type, arrow::Type::LIST>{});
+    case arrow::Type::DICTIONARY: return visitType(*dictionaryValueType(type), f);
     default: throw std::runtime_error("array type not supported to downcast: " + type.ToString());
     }
 }
@@ -256,6 +271,7 @@ auto visitType4(const TypePtr &type, F &&f)
     case arrow::Type::STRING: return f(std::integral_constant<arrow::Type::type, arrow::Type::STRING>{});
     case arrow::Type::TIMESTAMP: return f(std::integral_constant<arrow::Type::type, arrow::Type::TIMESTAMP>{});
     case arrow::Type::LIST: return f(std::integral_constant<arrow::Type::type, arrow::Type::LIST>{});
+    case arrow::Type::DICTIONARY: return visitType4(dictionaryValueType(*type), f);
     default: throw std::runtime_error("array type not supported to downcast: " + type->ToString());
     }
 }
@@ -362,10 +378,46 @@ inline auto append(Builder &builder, const std::optional<T> &value)
 
 //////////////////////////////////////////////////////////////////////////
 
+// Dispatches on the integer type of dictionary codes.
+template<typename F>
+auto visitIndexType(const arrow::DataType &type, F &&f)
+{
+    switch(type.id())
+    {
+    case arrow::Type::INT8 : return f(std::integral_constant<arrow::Type::type, arrow::Type::INT8 >{});
+    case arrow::Type::INT16: return f(std::integral_constant<arrow::Type::type, arrow::Type::INT16>{});
+    case arrow::Type::INT32: return f(std::integral_constant<arrow::Type::type, arrow::Type::INT32>{});
+    case arrow::Type::INT64: return f(std::integral_constant<arrow::Type::type, arrow::Type::INT64>{});
+    default: throw std::runtime_error("dictionary index type not supported: " + type.ToString());
+    }
+}
+
+// Calls f with pointer to the codes of dictionary-encoded array (its indices may be of any signed integer type).
+template<typename F>
+auto visitDictionaryCodes(const arrow::DictionaryArray &array, F &&f)
+{
+    const auto indices = array.indices();
+    switch(indices->type_id())
+    {
+    case arrow::Type::INT8 : return f(static_cast<const arrow::Int8Array &>(*indices).raw_values());
+    case arrow::Type::INT16: return f(static_cast<const arrow::Int16Array &>(*indices).raw_values());
+    case arrow::Type::INT32: return f(static_cast<const arrow::Int32Array &>(*indices).raw_values());
+    case arrow::Type::INT64: return f(static_cast<const arrow::Int64Array &>(*indices).raw_values());
+    default: throw std::runtime_error("dictionary index type not supported: " + indices->type()->ToString());
+    }
+}
+
+// Note: for dictionary-encoded arrays `type` is the type of the dictionary values.
 template <arrow::Type::type type>
 auto arrayValueAt(const arrow::Array &array, int32_t index)
 {
     using Array = typename TypeDescription<type>::Array;
+    if(array.type_id() == arrow::Type::DICTIONARY)
+    {
+        const auto &dictionaryArray = static_cast<const arrow::DictionaryArray &>(array);
+        const auto code = visitDictionaryCodes(dictionaryArray, [&] (auto *codes) { return static_cast<int32_t>(codes[index]); });
+        return arrayValueAtTyped(static_cast<const Array &>(*dictionaryArray.dictionary()), code);
+    }
     return arrayValueAtTyped(static_cast<const Array &>(array), index);
 }
 template <arrow::Type::type type>
@@ -373,16 +425,36 @@ auto tryArrayValueAt(const arrow::Array &array, int32_t index)
 {
     using T = typename TypeDescription<type>::ObservedType;
     if(array.IsValid(index))
-    {
-        using Array = typename TypeDescription<type>::Array;
-        return std::optional<T>(arrayValueAtTyped(static_cast<const Array &>(array), index));
-    }
+        return std::optional<T>(arrayValueAt<type>(array, index));
     return std::optional<T>{};
 }
 
+template <arrow::Type::type type, typename ElementF, typename NullF>
+void iterateOverDictionary(const arrow::DictionaryArray &array, ElementF &&handleElem, NullF &&handleNull)
+{
+    using Array = typename TypeDescription<type>::Array;
+    const auto dictionary = array.dictionary();
+    const auto &values = static_cast<const Array &>(*dictionary);
+    const auto N = static_cast<int32_t>(array.length());
+    const auto hasNulls = array.null_count() != 0;
+    visitDictionaryCodes(array, [&] (auto *codes)
+    {
+        for(int32_t row = 0; row < N; row++)
+        {
+            if(!hasNulls || array.IsValid(row))
+                handleElem(arrayValueAtTyped(values, static_cast<int32_t>(codes[row])));
+            else
+                handleNull();
+        }
+    });
+}
+
 template <arrow::Type::type type, typename ElementF, typename NullF>
 void iterateOver(const arrow::Array &array, ElementF &&handleElem, NullF &&handleNull)
 {
+    if(array.type_id() == arrow::Type::DICTIONARY)
+        return iterateOverDictionary<type>(static_cast<const arrow::DictionaryArray &>(array), handleElem, handleNull);
+
     const auto N = static_cast<int32_t>(array.length());
     const auto nullCount = array.null_count();
     //const auto nullBitmapData = array.null_bitmap_data();
@@ -417,7 +489,7 @@ void iterateOver(const arrow::Array &array, ElementF &&handleElem, NullF &&handl
 template <arrow::Type::type type, typename ElementF, typename NullF>
 void iterateOver(const arrow::ChunkedArray &arrays, ElementF &&handleElem, NullF &&handleNull)
 {
-    assert(type == arrays.type()->id());
+    assert(type == valueType(arrays.type())->id());
     for(auto &chunk : arrays.chunks())
     {
         iterateOver<type>(*chunk, handleElem, handleNull);
@@ -484,9 +556,13 @@ auto staticDowncastArray(const arrow::Array *array)
     return static_cast<const typename TypeDescription<type>::Array *>(array);
 }
 
+// Note: dictionary-encoded arrays must be decoded first, see `decodeDictionary`.
 template<typename Function>
 auto visitArray(const arrow::Array &array, Function &&f)
 {
+    if(array.type_id() == arrow::Type::DICTIONARY)
+        throw std::runtime_error("dictionary-encoded array must be decoded before being visited: " + array.type()->ToString());
+
     return visitType(*array.type(), [&] (auto id)
     {
         return f(staticDowncastArray<id.value>(&array));
@@ -682,6 +758,8 @@ using PossiblyChunkedArray = variant<std::shared_ptr<arrow::Array>, std::shared_
 DFH_EXPORT std::shared_ptr<arrow::Table> tableFromArrays(std::vector<PossiblyChunkedArray> arrays, std::vector<std::string> names = {}, std::vector<bool> nullables = {});
 DFH_EXPORT std::shared_ptr<arrow::Table> tableFromColumns(const std::vector<std::shared_ptr<arrow::Column>> &columns, const std::shared_ptr<arrow::Schema> &schema);
 DFH_EXPORT std::shared_ptr<arrow::Table> tableFromColumns(const std::vector<std::shared_ptr<arrow::Column>> &columns);
+// Chunks of the tables' columns become chunks of the result columns (no data is copied). Column names and types must match.
+DFH_EXPORT std::shared_ptr<arrow::Table> concatenateTables(const std::vector<std::shared_ptr<arrow::Table>> &tables);
 DFH_EXPORT std::shared_ptr<arrow::Table> replaceColumn(const arrow::Table &table, const arrow::Column &columnToBeReplaced, std::shared_ptr<arrow::Column> replaceWith);
 DFH_EXPORT std::shared_ptr<arrow::Table> replaceColumn(const arrow::Table &table, int index, std::shared_ptr<arrow::Column> column);
 
@@ -891,4 +969,16 @@ using ArrowTypeFromPtr = typename std::decay_t<ArrowDataTypePtr>::element_type;
 template<typename ArrowDataTypePtr>
 constexpr arrow::Type::type idFromDataPointer = std::decay_t<ArrowDataTypePtr>::element_type::type_id;
 
-DFH_EXPORT std::shared_ptr<arrow::Column> consolidate(std::shared_ptr<arrow::Column> column);
+DFH_EXPORT std::shared_ptr<arrow::Column> consolidate(std::shared_ptr<arrow::Column> column); // also decodes dictionary-encoded column
+
+// Dictionary-encoded arrays are converted into plain arrays of their values, other arrays are returned as they are.
+DFH_EXPORT std::shared_ptr<arrow::Array> decodeDictionary(std::shared_ptr<arrow::Array> array);
+DFH_EXPORT std::shared_ptr<arrow::Column> decodeDictionary(std::shared_ptr<arrow::Column> column);
+
+// Column of the codes of dictionary-encoded column and the inverse operation, that encodes codes with the dictionary of `field` type.
+DFH_EXPORT std::shared_ptr<arrow::Column> dictionaryIndices(const arrow::Column &column);
+DFH_EXPORT std::shared_ptr<arrow::Column> withDictionaryIndices(std::shared_ptr<arrow::Field> field, const arrow::Column &indices);
+
+// Re-encodes dictionary-encoded string arrays, so they all share a single dictionary (and can make a chunked array).
+// Resulting codes are 32-bit integers.
+DFH_EXPORT std::vector<std::shared_ptr<arrow::Array>> unifyDictionaries(const std::vector<std::shared_ptr<arrow::Array>> &arrays);
@@ -0,0 +1,78 @@
+#include "LazyTable.h"
+
+#include "ArrowUtilities.h"
+#include "Error.h"
+
+LazyTable::LazyTable(std::shared_ptr<arrow::Schema> schema, int64_t rowCount, ColumnLoader loader)
+    : loader(std::move(loader)), loaded(schema->num_fields())
+{
+    schema_ = std::move(schema);
+    num_rows_ = rowCount;
+}
+
+std::shared_ptr<arrow::Column> LazyTable::column(int i) const
+{
+    validateIndex(num_columns(), i);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    if(loaded[i])
+        return loaded[i];
+
+    auto column = loader(i);
+    const auto &expectedField = *schema_->field(i);
+    if(!column->field()->Equals(expectedField))
+        THROW("loaded column #{} is {} while {} was expected", i, column->field()->ToString(), expectedField.ToString());
+    if(column->length() != num_rows_)
+        THROW("loaded column `{}` has length {} while {} was expected", column->name(), column->length(), num_rows_);
+
+    loaded[i] = column;
+    return column;
+}
+
+arrow::Status LazyTable::RemoveColumn(int i, std::shared_ptr<arrow::Table> *out) const
+{
+    return materialize()->RemoveColumn(i, out);
+}
+
+arrow::Status LazyTable::AddColumn(int i, const std::shared_ptr<arrow::Column> &column, std::shared_ptr<arrow::Table> *out) const
+{
+    return materialize()->AddColumn(i, column, out);
+}
+
+arrow::Status LazyTable::SetColumn(int i, const std::shared_ptr<arrow::Column> &column, std::shared_ptr<arrow::Table> *out) const
+{
+    return materialize()->SetColumn(i, column, out);
+}
+
+std::shared_ptr<arrow::Table> LazyTable::ReplaceSchemaMetadata(const std::shared_ptr<const arrow::KeyValueMetadata> &metadata) const
+{
+    // columns keep being loaded lazily, the loader is shared
+    return std::make_shared<LazyTable>(schema_->AddMetadata(metadata), num_rows_, loader);
+}
+
+arrow::Status LazyTable::Flatten(arrow::MemoryPool *pool, std::shared_ptr<arrow::Table> *out) const
+{
+    return materialize()->Flatten(pool, out);
+}
+
+arrow::Status LazyTable::Validate() const
+{
+    // loaded columns are checked against the schema, there's nothing more that could be checked without loading them
+    return arrow::Status::OK();
+}
+
+std::vector<int> LazyTable::loadedColumns() const
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    std::vector<int> ret;
+    for(int i = 0; i < (int)loaded.size(); i++)
+        if(loaded[i])
+            ret.push_back(i);
+    return ret;
+}
+
+std::shared_ptr<arrow::Table> LazyTable::materialize() const
+{
+    const auto columns = transformToVector(iotaVector<int>(num_columns()), [&] (int i) { return column(i); });
+    return arrow::Table::Make(schema_, columns, num_rows_);
+}
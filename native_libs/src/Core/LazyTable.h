@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <arrow/table.h>
+
+#include "Common.h"
+
+// Table whose columns are loaded only when they are accessed for the first time. The schema and row count
+// are known upfront. Loaded columns are kept for the lifetime of the table, so the same column object is returned
+// for an index each time (helpers identifying columns by address, like `replaceColumn`, rely on that).
+// Accessing columns is thread-safe. Operations producing new tables (e.g. RemoveColumn) load all the columns.
+class DFH_EXPORT LazyTable : public arrow::Table
+{
+public:
+    using ColumnLoader = std::function<std::shared_ptr<arrow::Column>(int)>; // called with column index, never concurrently
+
+    LazyTable(std::shared_ptr<arrow::Schema> schema, int64_t rowCount, ColumnLoader loader);
+
+    virtual std::shared_ptr<arrow::Column> column(int i) const override;
+    virtual arrow::Status RemoveColumn(int i, std::shared_ptr<arrow::Table> *out) const override;
+    virtual arrow::Status AddColumn(int i, const std::shared_ptr<arrow::Column> &column, std::shared_ptr<arrow::Table> *out) const override;
+    virtual arrow::Status SetColumn(int i, const std::shared_ptr<arrow::Column> &column, std::shared_ptr<arrow::Table> *out) const override;
+    virtual std::shared_ptr<arrow::Table> ReplaceSchemaMetadata(const std::shared_ptr<const arrow::KeyValueMetadata> &metadata) const override;
+    virtual arrow::Status Flatten(arrow::MemoryPool *pool, std::shared_ptr<arrow::Table> *out) const override;
+    virtual arrow::Status Validate() const override;
+
+    std::vector<int> loadedColumns() const; // indices of the columns loaded so far, in increasing order
+
+    std::shared_ptr<arrow::Table> materialize() const; // regular table with all the columns loaded
+
+private:
+    ColumnLoader loader;
+
+    mutable std::mutex mutex;
+    mutable std::vector<std::shared_ptr<arrow::Column>> loaded; // [column index] => column, nullptr until loaded
+};
@@ -0,0 +1,16 @@
+#include "Parallel.h"
+
+namespace
+{
+    std::atomic<int> defaultThreadCount_{1};
+}
+
+int defaultThreadCount()
+{
+    return defaultThreadCount_;
+}
+
+void setDefaultThreadCount(int threadCount)
+{
+    defaultThreadCount_ = threadCount;
+}
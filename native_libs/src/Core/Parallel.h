@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Common.h"
+
+// Translates user-requested thread count into an actual one.
+// Non-positive values mean "use all available hardware threads".
+inline int resolveThreadCount(int requestedThreadCount)
+{
+    if(requestedThreadCount > 0)
+        return requestedThreadCount;
+
+    return std::max<int>(1, (int)std::thread::hardware_concurrency());
+}
+
+// Thread count used by operations that don't take one as a parameter, like sorting and permuting tables.
+// Same meaning as requested thread counts elsewhere; defaults to 1, so such operations are single-threaded unless enabled.
+DFH_EXPORT int defaultThreadCount();
+DFH_EXPORT void setDefaultThreadCount(int threadCount);
+
+// Calls f(i) for each i in [0, taskCount) using at most threadCount threads
+// (the calling thread is one of them). Tasks are consumed in increasing order
+// but may complete in any order. If any task throws, the remaining tasks are
+// abandoned and the first exception is rethrown on the calling thread.
+template<typename F>
+void parallelFor(int64_t taskCount, int threadCount, F &&f)
+{
+    const auto workerCount = (int)std::min<int64_t>(resolveThreadCount(threadCount), taskCount);
+    if(workerCount <= 1)
+    {
+        for(int64_t i = 0; i < taskCount; i++)
+            f(i);
+        return;
+    }
+
+    std::atomic<int64_t> nextTask{0};
+    std::atomic_bool failed{false};
+    std::exception_ptr firstError;
+    std::mutex errorMutex;
+
+    auto worker = [&]
+    {
+        try
+        {
+            for(int64_t i = nextTask++; i < taskCount && !failed; i = nextTask++)
+                f(i);
+        }
+        catch(...)
+        {
+            std::unique_lock<std::mutex> lock{errorMutex};
+            if(!failed.exchange(true))
+                firstError = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workerCount - 1);
+    for(int i = 1; i < workerCount; i++)
+        threads.emplace_back(worker);
+
+    worker();
+
+    for(auto &thread : threads)
+        thread.join();
+
+    if(firstError)
+        std::rethrow_exception(firstError);
+}
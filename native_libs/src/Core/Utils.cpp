@@ -1,11 +1,122 @@
 #include "Utils.h"
 #include <numeric>
 
-std::optional<Timestamp> parseTimestamp(std::string_view text)
+namespace
 {
-    std::istringstream input((std::string)text);
+    // Reads exactly `count` decimal digits. Returns false if any of them is not a digit.
+    bool readDigits(const char *text, int count, int &out)
+    {
+        out = 0;
+        for(int i = 0; i < count; i++)
+        {
+            const auto digit = (unsigned)(text[i] - '0');
+            if(digit > 9)
+                return false;
+            out = out * 10 + (int)digit;
+        }
+        return true;
+    }
+
+    // Days since 1970-01-01 of the given proleptic Gregorian calendar date.
+    // See http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+    int64_t daysFromCivil(int64_t y, unsigned m, unsigned d)
+    {
+        y -= m <= 2;
+        const auto era = (y >= 0 ? y : y - 399) / 400;
+        const auto yearOfEra = (unsigned)(y - era * 400);
+        const auto dayOfYear = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+        const auto dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + (int64_t)dayOfEra - 719468;
+    }
+
+    unsigned daysInMonth(int year, int month)
+    {
+        static constexpr unsigned char lengths[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+        const bool leapYear = year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+        return lengths[month - 1] + (month == 2 && leapYear);
+    }
+
+    enum class FastParseResult
+    {
+        Parsed, Invalid, UnknownFormat
+    };
+
+    // Handles `YYYY-MM-DD`, optionally followed by `THH:MM:SS`, fractional seconds and `Z`.
+    // Text that doesn't follow this layout is left for the general parser.
+    FastParseResult parseIsoTimestamp(std::string_view text, Timestamp &out)
+    {
+        const auto data = text.data();
+        const auto size = text.size();
+        int year, month, day;
+        if(size < 10 || data[4] != '-' || data[7] != '-'
+            || !readDigits(data, 4, year) || !readDigits(data + 5, 2, month) || !readDigits(data + 8, 2, day))
+            return FastParseResult::UnknownFormat;
+
+        int64_t nanoseconds = 0;
+        if(size > 10)
+        {
+            int hour, minute, second;
+            if(size < 19 || data[10] != 'T' || data[13] != ':' || data[16] != ':'
+                || !readDigits(data + 11, 2, hour) || !readDigits(data + 14, 2, minute) || !readDigits(data + 17, 2, second))
+                return FastParseResult::UnknownFormat;
+            if(hour > 23 || minute > 59 || second > 59)
+                return FastParseResult::Invalid;
 
+            size_t position = 19;
+            int64_t fraction = 0;
+            int64_t fractionScale = 1'000'000'000;
+            if(position < size && data[position] == '.')
+            {
+                const auto fractionStart = ++position;
+                for(; position < size && (unsigned)(data[position] - '0') <= 9; position++)
+                {
+                    // digits beyond nanosecond precision are ignored
+                    if(fractionScale > 1)
+                    {
+                        fraction = fraction * 10 + (data[position] - '0');
+                        fractionScale /= 10;
+                    }
+                }
+                if(position == fractionStart)
+                    return FastParseResult::UnknownFormat;
+            }
+            if(position < size && data[position] == 'Z')
+                ++position;
+            if(position != size)
+                return FastParseResult::UnknownFormat;
+
+            nanoseconds = ((hour * 60 + minute) * 60 + second) * 1'000'000'000LL + fraction * fractionScale;
+        }
+
+        if(month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month))
+            return FastParseResult::Invalid;
+
+        const auto days = daysFromCivil(year, month, day);
+        out = Timestamp{ days * 86'400'000'000'000LL + nanoseconds };
+        return FastParseResult::Parsed;
+    }
+
+    // The general parser is costly and most of fields (e.g. numbers during type deduction) can be rejected upfront.
+    bool mightBeDate(std::string_view text)
+    {
+        return text.size() >= 5 && (unsigned)(text[0] - '0') <= 9 && text.find('-', 1) != std::string_view::npos;
+    }
+}
+
+std::optional<Timestamp> parseTimestamp(std::string_view text)
+{
     Timestamp out;
+    switch(parseIsoTimestamp(text, out))
+    {
+    case FastParseResult::Parsed:  return out;
+    case FastParseResult::Invalid: return std::nullopt;
+    default:                       break;
+    }
+
+    if(!mightBeDate(text))
+        return std::nullopt;
+
+    std::istringstream input((std::string)text);
     input >> date::parse("%F", out);
     if(input && input.rdbuf()->in_avail() == 0)
         return out;
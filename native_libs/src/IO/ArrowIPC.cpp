@@ -0,0 +1,65 @@
+#include "ArrowIPC.h"
+#include "IO.h"
+
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+#include <arrow/ipc/writer.h>
+#include <arrow/record_batch.h>
+#include <arrow/table.h>
+
+#include "Core/ArrowUtilities.h"
+
+std::string FormatArrowIPC::fileSignature() const
+{
+    return "ARROW1";
+}
+
+std::shared_ptr<arrow::Table> FormatArrowIPC::read(std::string_view filePath, const ArrowIPCReadOptions &options) const
+{
+    // Record batches read from a memory-mapped file slice its mapping instead of copying,
+    // the buffers keep the mapping alive for as long as they are used.
+    std::shared_ptr<arrow::io::MemoryMappedFile> file;
+    checkStatus(arrow::io::MemoryMappedFile::Open((std::string)filePath, arrow::io::FileMode::READ, &file));
+
+    std::shared_ptr<arrow::ipc::RecordBatchFileReader> reader;
+    checkStatus(arrow::ipc::RecordBatchFileReader::Open(file, &reader));
+
+    const auto schema = reader->schema();
+    const auto names = transformToVector(schema->fields(), [] (auto &&field) { return field->name(); });
+    const auto selectedColumns = selectColumnIndices(options.columns, names);
+
+    std::vector<std::vector<std::shared_ptr<arrow::Array>>> chunks(selectedColumns.size());
+    for(int batchIndex = 0; batchIndex < reader->num_record_batches(); batchIndex++)
+    {
+        std::shared_ptr<arrow::RecordBatch> batch;
+        checkStatus(reader->ReadRecordBatch(batchIndex, &batch));
+        for(size_t i = 0; i < selectedColumns.size(); i++)
+            chunks[i].push_back(batch->column(selectedColumns[i]));
+    }
+
+    // built by hand rather than with Table::FromRecordBatches, so files without batches give empty columns
+    std::vector<std::shared_ptr<arrow::Column>> columns;
+    for(size_t i = 0; i < selectedColumns.size(); i++)
+    {
+        const auto field = schema->field(selectedColumns[i]);
+        columns.push_back(std::make_shared<arrow::Column>(field, std::make_shared<arrow::ChunkedArray>(chunks[i], field->type())));
+    }
+    return tableFromColumns(columns);
+}
+
+void FormatArrowIPC::write(std::string_view filePath, const arrow::Table &table, const ArrowIPCWriteOptions &options) const
+{
+    std::shared_ptr<arrow::io::FileOutputStream> out;
+    checkStatus(arrow::io::FileOutputStream::Open((std::string)filePath, &out));
+
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> writer;
+    checkStatus(arrow::ipc::RecordBatchFileWriter::Open(out.get(), table.schema(), &writer));
+    checkStatus(writer->WriteTable(table));
+    checkStatus(writer->Close());
+    checkStatus(out->Close());
+}
+
+std::vector<std::string> FormatArrowIPC::fileExtensions() const
+{
+    return { "arrow" };
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "Core/Common.h"
+#include "IO.h"
+
+namespace arrow
+{
+    class Table;
+}
+
+struct ArrowIPCReadOptions
+{
+    std::vector<ColumnSelector> columns = {}; // columns to be read, in the given order; empty means all
+};
+
+struct ArrowIPCWriteOptions
+{
+};
+
+// Arrow IPC file format (the "random access" one, with a footer). Reading maps the file into memory
+// and the table buffers point directly into the mapping, so no column data is copied or decoded.
+// Each record batch of the file becomes a separate chunk of the table columns.
+struct DFH_EXPORT FormatArrowIPC : TableFileHandlerWithOptions<ArrowIPCReadOptions, ArrowIPCWriteOptions>
+{
+    using TableFileHandler::read;
+    using TableFileHandler::write;
+
+    virtual std::string fileSignature() const override;
+    virtual std::shared_ptr<arrow::Table> read(std::string_view filePath, const ArrowIPCReadOptions &options) const override;
+    virtual void write(std::string_view filePath, const arrow::Table &table, const ArrowIPCWriteOptions &options) const override;
+    virtual std::vector<std::string> fileExtensions() const override;
+};
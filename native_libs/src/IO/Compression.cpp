@@ -0,0 +1,288 @@
+#include "Compression.h"
+#include "IO.h"
+
+#include <algorithm>
+#include <array>
+#include <climits>
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#ifndef DISABLE_GZIP
+#include <zlib.h>
+#endif
+
+#ifndef DISABLE_ZSTD
+#include <zstd.h>
+#endif
+
+// Incremental decompression of a single stream. Decoders keep whatever state they need between calls.
+struct DecompressingReader::Decoder
+{
+    virtual ~Decoder() = default;
+
+    // Consumes some input (advancing `in`) and returns the number of bytes written to `out`.
+    virtual size_t decode(const char *&in, const char *inEnd, char *out, size_t outSize) = 0;
+    virtual bool isComplete() const = 0; // whether the data decoded so far forms whole streams (i.e. is not truncated)
+};
+
+namespace
+{
+#ifndef DISABLE_GZIP
+    struct GzipDecoder : DecompressingReader::Decoder
+    {
+        z_stream stream{};
+        bool memberEnded = false;
+
+        GzipDecoder()
+        {
+            // 32 added to window bits enables automatic detection of gzip and zlib headers
+            if(inflateInit2(&stream, MAX_WBITS + 32) != Z_OK)
+                THROW("failed to initialize gzip decompression");
+        }
+        ~GzipDecoder()
+        {
+            inflateEnd(&stream);
+        }
+
+        virtual size_t decode(const char *&in, const char *inEnd, char *out, size_t outSize) override
+        {
+            if(memberEnded)
+            {
+                if(in == inEnd)
+                    return 0;
+
+                // there is another gzip member concatenated to the previous one
+                inflateReset(&stream);
+                memberEnded = false;
+            }
+
+            stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in));
+            stream.avail_in = (uInt)std::min<size_t>(std::distance(in, inEnd), UINT_MAX);
+            stream.next_out = reinterpret_cast<Bytef *>(out);
+            stream.avail_out = (uInt)std::min<size_t>(outSize, UINT_MAX);
+
+            const auto status = inflate(&stream, Z_NO_FLUSH);
+            if(status == Z_STREAM_END)
+                memberEnded = true;
+            else if(status != Z_OK && status != Z_BUF_ERROR) // buffer error just means that no progress was possible
+                THROW("corrupted gzip data: {}", stream.msg ? stream.msg : "unknown error");
+
+            in = reinterpret_cast<const char *>(stream.next_in);
+            return std::distance(out, reinterpret_cast<char *>(stream.next_out));
+        }
+        virtual bool isComplete() const override
+        {
+            return memberEnded;
+        }
+    };
+#endif // DISABLE_GZIP
+
+#ifndef DISABLE_ZSTD
+    struct ZstdDecoder : DecompressingReader::Decoder
+    {
+        ZSTD_DStream *stream = ZSTD_createDStream();
+        size_t lastResult = 0; // zero when the last frame was completely decoded and flushed
+
+        ZstdDecoder()
+        {
+            if(!stream)
+                THROW("failed to initialize zstd decompression");
+            ZSTD_initDStream(stream);
+        }
+        ~ZstdDecoder()
+        {
+            ZSTD_freeDStream(stream);
+        }
+
+        virtual size_t decode(const char *&in, const char *inEnd, char *out, size_t outSize) override
+        {
+            ZSTD_inBuffer input{ in, (size_t)std::distance(in, inEnd), 0 };
+            ZSTD_outBuffer output{ out, outSize, 0 };
+
+            // next frames, if present, are decoded by the same stream without a need to reset it
+            const auto result = ZSTD_decompressStream(stream, &output, &input);
+            if(ZSTD_isError(result))
+                THROW("corrupted zstd data: {}", ZSTD_getErrorName(result));
+
+            // after the frame end, a call without progress would report the expected header size of the next frame
+            if(input.pos || output.pos)
+                lastResult = result;
+            in += input.pos;
+            return output.pos;
+        }
+        virtual bool isComplete() const override
+        {
+            return lastResult == 0;
+        }
+    };
+#endif // DISABLE_ZSTD
+
+    std::unique_ptr<DecompressingReader::Decoder> makeDecoder(Compression compression)
+    {
+        switch(compression)
+        {
+        case Compression::None:
+            return nullptr;
+#ifndef DISABLE_GZIP
+        case Compression::Gzip:
+            return std::make_unique<GzipDecoder>();
+#endif
+#ifndef DISABLE_ZSTD
+        case Compression::Zstd:
+            return std::make_unique<ZstdDecoder>();
+#endif
+        default:
+            THROW("The library was compiled without {} support!", compressionName(compression));
+        }
+    }
+}
+
+std::string_view compressionName(Compression compression)
+{
+    switch(compression)
+    {
+    case Compression::None: return "none";
+    case Compression::Gzip: return "gzip";
+    case Compression::Zstd: return "zstd";
+    default:                THROW("unknown compression {}", (int)compression);
+    }
+}
+
+bool isCompressionSupported(Compression compression)
+{
+    switch(compression)
+    {
+    case Compression::None: return true;
+#ifndef DISABLE_GZIP
+    case Compression::Gzip: return true;
+#endif
+#ifndef DISABLE_ZSTD
+    case Compression::Zstd: return true;
+#endif
+    default:                return false;
+    }
+}
+
+Compression detectCompression(std::string_view filePath)
+{
+    auto input = openFileToRead(filePath);
+
+    std::array<char, 4> magic{};
+    input.read(magic.data(), magic.size());
+    return detectCompression(std::string_view(magic.data(), input.gcount()), filePath);
+}
+
+Compression detectCompression(std::string_view fileStart, std::string_view filePath)
+{
+    if(boost::starts_with(fileStart, "\x1f\x8b"sv))
+        return Compression::Gzip;
+    if(boost::starts_with(fileStart, "\x28\xb5\x2f\xfd"sv))
+        return Compression::Zstd;
+
+    // e.g. empty file that was meant to be compressed -- better to fail decompressing it than to read it as is
+    if(fileStart.size() < 4)
+    {
+        if(boost::iends_with(filePath, ".gz"))
+            return Compression::Gzip;
+        if(boost::iends_with(filePath, ".zst"))
+            return Compression::Zstd;
+    }
+
+    return Compression::None;
+}
+
+DecompressingReader::DecompressingReader(std::string_view filePath, size_t inputBlockSize /*= 1 << 20*/)
+    : DecompressingReader(openFileToRead(filePath), detectCompression(filePath), inputBlockSize)
+{
+}
+
+DecompressingReader::DecompressingReader(std::string_view filePath, Compression compression, size_t inputBlockSize /*= 1 << 20*/)
+    : DecompressingReader(openFileToRead(filePath), compression, inputBlockSize)
+{
+}
+
+DecompressingReader::DecompressingReader(std::ifstream input, Compression compression, size_t inputBlockSize /*= 1 << 20*/)
+    : compression_(compression)
+    , input(std::move(input))
+    , inputBlockSize(inputBlockSize)
+    , decoder(makeDecoder(compression_))
+{
+    if(inputBlockSize == 0)
+        THROW("input block size must be positive");
+}
+
+DecompressingReader::~DecompressingReader() = default;
+
+size_t DecompressingReader::read(char *out, size_t size)
+{
+    if(!decoder)
+    {
+        input.read(out, size);
+        if(input.bad())
+            THROW("failed reading stream");
+        return input.gcount();
+    }
+
+    size_t written = 0;
+    while(written < size)
+    {
+        if(inputPosition == inputBlock.size() && !inputExhausted)
+            refillInput();
+
+        const auto inputBegin = inputBlock.data() + inputPosition;
+        auto inputItr = static_cast<const char *>(inputBegin);
+        const auto decoded = decoder->decode(inputItr, inputBlock.data() + inputBlock.size(), out + written, size - written);
+        inputPosition += std::distance<const char *>(inputBegin, inputItr);
+        written += decoded;
+
+        if(decoded == 0 && inputExhausted && inputPosition == inputBlock.size())
+        {
+            if(!decoder->isComplete())
+                THROW("compressed data is truncated");
+            break;
+        }
+    }
+    return written;
+}
+
+void DecompressingReader::refillInput()
+{
+    inputBlock.resize(inputBlockSize);
+    input.read(inputBlock.data(), inputBlock.size());
+    inputBlock.resize(input.gcount());
+    inputPosition = 0;
+
+    if(input.eof())
+        inputExhausted = true;
+    else if(!input)
+        THROW("failed reading stream");
+}
+
+std::string getDecompressedFileContents(std::string_view filePath, std::optional<Compression> compression /*= std::nullopt*/)
+{
+    try
+    {
+        DecompressingReader reader{filePath, compression ? *compression : detectCompression(filePath)};
+
+        std::string contents;
+        while(true)
+        {
+            // growing geometrically, so large files are not read in tiny steps
+            const auto blockSize = std::max<size_t>(1 << 20, contents.size());
+            const auto oldSize = contents.size();
+            contents.resize(oldSize + blockSize);
+            const auto readCount = reader.read(&contents[oldSize], blockSize);
+            contents.resize(oldSize + readCount);
+            if(readCount < blockSize)
+                return contents;
+        }
+    }
+    catch(CannotOpenToRead &)
+    {
+        throw;
+    }
+    catch(std::exception &e)
+    {
+        THROW("Failed to load file {}: {}", filePath, e.what());
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Core/Common.h"
+
+enum class Compression : int8_t
+{
+    None, Gzip, Zstd
+};
+
+DFH_EXPORT std::string_view compressionName(Compression compression);
+DFH_EXPORT bool isCompressionSupported(Compression compression); // whether this build is able to decompress such files
+
+// Recognizes compression by the magic bytes at the file start. Files too short to have them are recognized by extension.
+DFH_EXPORT Compression detectCompression(std::string_view filePath);
+DFH_EXPORT Compression detectCompression(std::string_view fileStart, std::string_view filePath); // with the first bytes of the file already read
+
+// Reads file contents sequentially, decompressing them on the fly if the file is compressed.
+// Concatenated gzip members and zstd frames are read as a single stream.
+class DFH_EXPORT DecompressingReader
+{
+public:
+    struct Decoder;
+
+    explicit DecompressingReader(std::string_view filePath, size_t inputBlockSize = 1 << 20);
+    DecompressingReader(std::string_view filePath, Compression compression, size_t inputBlockSize = 1 << 20); // compression already known, e.g. from `FileHeader`
+    DecompressingReader(std::ifstream input, Compression compression, size_t inputBlockSize = 1 << 20); // reads the stream from its current position
+    ~DecompressingReader();
+
+    DecompressingReader(const DecompressingReader &) = delete;
+    DecompressingReader &operator=(const DecompressingReader &) = delete;
+
+    Compression compression() const { return compression_; }
+
+    // Returns the number of bytes written to `out`. It is less than `size` only when the end of contents was reached.
+    // Throws if the compressed data is corrupted or truncated.
+    size_t read(char *out, size_t size);
+
+private:
+    Compression compression_{};
+    std::ifstream input;
+    size_t inputBlockSize{};
+    std::vector<char> inputBlock; // compressed data read from file, decoded up to `inputPosition`
+    size_t inputPosition = 0;
+    bool inputExhausted = false;
+    std::unique_ptr<Decoder> decoder; // nullptr for uncompressed files
+
+    void refillInput();
+};
+
+DFH_EXPORT std::string getDecompressedFileContents(std::string_view filePath, std::optional<Compression> compression = std::nullopt); // detected if not given
@@ -0,0 +1,258 @@
+#include "CsvCache.h"
+#include "ArrowIPC.h"
+#include "IO.h"
+#include "LoadJob.h"
+#include "Core/Logger.h"
+
+#include <algorithm>
+#include <ctime>
+#include <sstream>
+#include <vector>
+
+#include <arrow/table.h>
+
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+    // FNV-1a, as entry names must not change between runs (and builds)
+    uint64_t hashKey(std::string_view key)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for(unsigned char c : key)
+        {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    struct CacheEntry
+    {
+        fs::path path; // of the table copy, the key file has the same stem
+        int64_t size;
+        std::time_t lastUsed;
+    };
+
+    std::vector<CacheEntry> listEntries(const fs::path &directory)
+    {
+        std::vector<CacheEntry> entries;
+        boost::system::error_code ec;
+        for(fs::directory_iterator itr{directory, ec}, end; !ec && itr != end; itr.increment(ec))
+        {
+            const auto &path = itr->path();
+            if(path.extension() != ".arrow")
+                continue;
+
+            // entries may disappear while being listed, if another process evicts them
+            const auto size = fs::file_size(path, ec);
+            const auto lastUsed = fs::last_write_time(path, ec);
+            if(!ec)
+                entries.push_back(CacheEntry{ path, (int64_t)size, lastUsed });
+            ec.clear();
+        }
+        return entries;
+    }
+
+    std::string describeOptions(const CsvReadOptions &options)
+    {
+        std::ostringstream out;
+        out << (int)options.fieldSeparator << ' ' << (int)options.recordSeparator << ' ' << (int)options.quote << '\n';
+
+        out << "header " << options.header.index();
+        if(auto names = get_if<std::vector<std::string>>(&options.header))
+            for(auto &name : *names)
+                out << ' ' << name.size() << ':' << name;
+        out << '\n';
+
+        out << "types";
+        for(auto &columnType : options.columnTypes)
+            out << ' ' << columnType.type->ToString() << '/' << columnType.nullable << '/' << columnType.deduced;
+        out << '\n';
+
+        out << "columns";
+        for(auto &selector : options.columns)
+        {
+            if(auto index = get_if<int>(&selector))
+                out << " #" << *index;
+            else
+            {
+                const auto &name = get<std::string>(selector);
+                out << ' ' << name.size() << ':' << name;
+            }
+        }
+        out << '\n';
+
+        out << "depth " << options.typeDeductionDepth << " dictionary " << (int)options.dictionaryEncoding << '\n';
+        out << "predicate " << options.predicate;
+        return out.str();
+    }
+
+    struct ActiveCache
+    {
+        std::mutex mx;
+        std::shared_ptr<CsvCache> cache;
+
+        static ActiveCache &instance()
+        {
+            static ActiveCache activeCache;
+            return activeCache;
+        }
+    };
+}
+
+CsvCache::CsvCache(std::string directory, int64_t sizeLimit)
+    : directory(std::move(directory))
+    , sizeLimit(sizeLimit)
+{
+    if(sizeLimit <= 0)
+        THROW("CSV cache size limit must be positive, got {}", sizeLimit);
+
+    fs::create_directories(this->directory);
+}
+
+std::string CsvCache::key(std::string_view filePath, const CsvReadOptions &options) const
+{
+    boost::system::error_code ec;
+    const auto path = fs::absolute(std::string(filePath));
+    const auto size = fs::file_size(path, ec);
+    const auto modified = fs::last_write_time(path, ec);
+    if(ec)
+        throw CannotOpenToRead(filePath);
+
+    return fmt::format("{}\n{} {}\n{}", path.string(), size, modified, describeOptions(options));
+}
+
+std::shared_ptr<arrow::Table> CsvCache::read(std::string_view filePath, const CsvReadOptions &options)
+{
+    const auto key = this->key(filePath, options);
+    const auto entryName = fmt::format("{:016x}", hashKey(key));
+    const auto copyPath = fs::path(directory) / (entryName + ".arrow");
+    const auto keyPath = fs::path(directory) / (entryName + ".key");
+
+    boost::system::error_code ec;
+    if(fs::exists(copyPath, ec) && fs::exists(keyPath, ec))
+    {
+        try
+        {
+            // key file guards against hash collisions
+            if(getFileContents(keyPath.string()) == key)
+            {
+                auto table = FormatArrowIPC{}.read(copyPath.string());
+                fs::last_write_time(copyPath, std::time(nullptr), ec); // marks as recently used
+                ++hits_;
+                LOG("serving {} from cached copy {}", filePath, copyPath.string());
+
+                if(options.progress)
+                {
+                    options.progress->bytesTotal = options.progress->bytesRead = (int64_t)fs::file_size(std::string(filePath), ec);
+                    options.progress->rowsParsed = table->num_rows();
+                }
+                return table;
+            }
+        }
+        catch(std::exception &e)
+        {
+            // entry might have been evicted meanwhile, the file will be parsed
+            LOG("cannot use cached copy {}: {}", copyPath.string(), e.what());
+        }
+    }
+
+    ++misses_;
+    auto table = FormatCSV{}.readUncached(filePath, options);
+    try
+    {
+        store(entryName, key, *table);
+    }
+    catch(std::exception &e)
+    {
+        // failing to cache (e.g. due to lack of disk space) does not make the read fail
+        LOG("cannot store cached copy of {}: {}", filePath, e.what());
+    }
+    return table;
+}
+
+void CsvCache::store(const std::string &entryName, const std::string &key, const arrow::Table &table)
+{
+    std::unique_lock<std::mutex> lock{storeMutex};
+
+    // Copy is written under a temporary name and renamed, so other readers never see it partially written.
+    boost::system::error_code ec;
+    const auto temporaryPath = fs::path(directory) / fs::unique_path("%%%%-%%%%-%%%%-%%%%.tmp");
+    try
+    {
+        FormatArrowIPC{}.write(temporaryPath.string(), table);
+    }
+    catch(...)
+    {
+        fs::remove(temporaryPath, ec);
+        throw;
+    }
+
+    const auto size = (int64_t)fs::file_size(temporaryPath);
+    if(size > sizeLimit)
+    {
+        LOG("copy of {} bytes does not fit in the cache limit of {} bytes", size, sizeLimit);
+        fs::remove(temporaryPath, ec);
+        return;
+    }
+
+    evictToFit(size);
+    writeFile((fs::path(directory) / (entryName + ".key")).string(), key);
+    fs::rename(temporaryPath, fs::path(directory) / (entryName + ".arrow"));
+}
+
+void CsvCache::evictToFit(int64_t incomingSize)
+{
+    auto entries = listEntries(directory);
+    std::sort(entries.begin(), entries.end(), [] (auto &&lhs, auto &&rhs) { return lhs.lastUsed < rhs.lastUsed; });
+
+    int64_t totalSize = 0;
+    for(auto &entry : entries)
+        totalSize += entry.size;
+
+    boost::system::error_code ec;
+    for(auto &entry : entries)
+    {
+        if(totalSize + incomingSize <= sizeLimit)
+            break;
+
+        LOG("evicting {} ({} bytes)", entry.path.string(), entry.size);
+        fs::remove(entry.path, ec);
+        fs::remove(fs::path(entry.path).replace_extension(".key"), ec);
+        totalSize -= entry.size;
+    }
+}
+
+int64_t CsvCache::cachedBytes() const
+{
+    int64_t totalSize = 0;
+    for(auto &entry : listEntries(directory))
+        totalSize += entry.size;
+    return totalSize;
+}
+
+std::shared_ptr<CsvCache> CsvCache::active()
+{
+    auto &activeCache = ActiveCache::instance();
+    std::unique_lock<std::mutex> lock{activeCache.mx};
+    return activeCache.cache;
+}
+
+void CsvCache::enable(std::string directory, int64_t sizeLimit)
+{
+    auto cache = std::make_shared<CsvCache>(std::move(directory), sizeLimit);
+
+    auto &activeCache = ActiveCache::instance();
+    std::unique_lock<std::mutex> lock{activeCache.mx};
+    activeCache.cache = std::move(cache);
+}
+
+void CsvCache::disable()
+{
+    auto &activeCache = ActiveCache::instance();
+    std::unique_lock<std::mutex> lock{activeCache.mx};
+    activeCache.cache = nullptr;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "Core/Common.h"
+#include "csv.h"
+
+namespace arrow
+{
+    class Table;
+}
+
+// Keeps Arrow IPC copies of parsed CSV files in a directory, so that reading the same file again only maps the copy.
+// Entries are keyed by the absolute file path, its size and modification time and by the read options that affect
+// the result (thread count does not). Modification times have a resolution of a second, so a file rewritten within
+// the second it was cached in, keeping its size, is not noticed. When the total size of the copies exceeds the limit,
+// the least recently used ones are removed. Recency is kept in the copies' modification times, so it survives across
+// processes.
+//
+// Once enabled, the cache serves `FormatCSV::read` (and so `readTableFromFile`) calls for all CSV files.
+class DFH_EXPORT CsvCache
+{
+    std::string directory;
+    int64_t sizeLimit;
+    std::atomic<int64_t> hits_{0};
+    std::atomic<int64_t> misses_{0};
+    std::mutex storeMutex; // serializes storing and evicting
+
+    void store(const std::string &entryName, const std::string &key, const arrow::Table &table);
+    void evictToFit(int64_t incomingSize); // expects the store lock to be held
+
+public:
+    CsvCache(std::string directory, int64_t sizeLimit);
+
+    std::shared_ptr<arrow::Table> read(std::string_view filePath, const CsvReadOptions &options);
+    std::string key(std::string_view filePath, const CsvReadOptions &options) const; // throws CannotOpenToRead
+
+    int64_t hits() const { return hits_; }
+    int64_t misses() const { return misses_; }
+    int64_t cachedBytes() const; // total size of the copies in the directory
+
+    static std::shared_ptr<CsvCache> active(); // nullptr if the cache is not enabled
+    static void enable(std::string directory, int64_t sizeLimit); // creates the directory if needed, resets counters
+    static void disable(); // copies stay in the directory for later use
+};
@@ -0,0 +1,238 @@
+#include "CsvScanner.h"
+
+#include <atomic>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define DFH_SIMD_X64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2 // MSVC allows using intrinsics of any instruction set without special flags
+#endif
+
+namespace
+{
+    int countTrailingZeros(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return (int)index;
+#else
+        return __builtin_ctzll(value);
+#endif
+    }
+
+    // Bit i of the result is the xor of bits [0, i] of the input. For quote character mask
+    // this yields mask of characters that are within quotes (opening quote included, closing excluded).
+    uint64_t prefixXor(uint64_t bits)
+    {
+        bits ^= bits << 1;
+        bits ^= bits << 2;
+        bits ^= bits << 4;
+        bits ^= bits << 8;
+        bits ^= bits << 16;
+        bits ^= bits << 32;
+        return bits;
+    }
+
+    // Returns mask with all bits set to the highest bit of given value.
+    uint64_t broadcastLastBit(uint64_t bits)
+    {
+        return bits >> 63 ? ~uint64_t{0} : uint64_t{0};
+    }
+
+    const char *findFirstOfScalar(const char *begin, const char *end, char a, char b, char c)
+    {
+        for(; begin != end; ++begin)
+        {
+            const auto ch = *begin;
+            if(ch == a || ch == b || ch == c)
+                break;
+        }
+        return begin;
+    }
+
+    const char *findUnquotedSeparatorScalar(const char *begin, const char *end, char recordSeparator, char quote, bool &inQuotes)
+    {
+        for(; begin != end; ++begin)
+        {
+            const auto ch = *begin;
+            if(ch == quote)
+                inQuotes = !inQuotes;
+            else if(ch == recordSeparator && !inQuotes)
+                break;
+        }
+        return begin;
+    }
+
+#ifdef DFH_SIMD_X64
+    // SSE2 is a part of x86-64 baseline, so there's no need for target attributes.
+
+    const char *findFirstOfSse2(const char *begin, const char *end, char a, char b, char c)
+    {
+        const auto as = _mm_set1_epi8(a);
+        const auto bs = _mm_set1_epi8(b);
+        const auto cs = _mm_set1_epi8(c);
+        for(; end - begin >= 16; begin += 16)
+        {
+            const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+            const auto matches = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, as), _mm_cmpeq_epi8(block, bs)), _mm_cmpeq_epi8(block, cs));
+            if(const auto mask = (uint32_t)_mm_movemask_epi8(matches))
+                return begin + countTrailingZeros(mask);
+        }
+        return findFirstOfScalar(begin, end, a, b, c);
+    }
+
+    const char *findUnquotedSeparatorSse2(const char *begin, const char *end, char recordSeparator, char quote, bool &inQuotes)
+    {
+        const auto quotes = _mm_set1_epi8(quote);
+        const auto separators = _mm_set1_epi8(recordSeparator);
+        auto quotedCarry = inQuotes ? ~uint64_t{0} : uint64_t{0};
+        for(; end - begin >= 64; begin += 64)
+        {
+            uint64_t quoteMask = 0, separatorMask = 0;
+            for(int i = 0; i < 4; i++)
+            {
+                const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin + 16 * i));
+                quoteMask |= uint64_t((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, quotes))) << (16 * i);
+                separatorMask |= uint64_t((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, separators))) << (16 * i);
+            }
+
+            const auto quoted = prefixXor(quoteMask) ^ quotedCarry;
+            if(const auto unquotedSeparators = separatorMask & ~quoted)
+            {
+                inQuotes = false;
+                return begin + countTrailingZeros(unquotedSeparators);
+            }
+            quotedCarry = broadcastLastBit(quoted);
+        }
+        inQuotes = quotedCarry != 0;
+        return findUnquotedSeparatorScalar(begin, end, recordSeparator, quote, inQuotes);
+    }
+
+    TARGET_AVX2 const char *findFirstOfAvx2(const char *begin, const char *end, char a, char b, char c)
+    {
+        const auto as = _mm256_set1_epi8(a);
+        const auto bs = _mm256_set1_epi8(b);
+        const auto cs = _mm256_set1_epi8(c);
+        for(; end - begin >= 32; begin += 32)
+        {
+            const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+            const auto matches = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, as), _mm256_cmpeq_epi8(block, bs)), _mm256_cmpeq_epi8(block, cs));
+            if(const auto mask = (uint32_t)_mm256_movemask_epi8(matches))
+                return begin + countTrailingZeros(mask);
+        }
+        return findFirstOfSse2(begin, end, a, b, c);
+    }
+
+    TARGET_AVX2 const char *findUnquotedSeparatorAvx2(const char *begin, const char *end, char recordSeparator, char quote, bool &inQuotes)
+    {
+        const auto quotes = _mm256_set1_epi8(quote);
+        const auto separators = _mm256_set1_epi8(recordSeparator);
+        auto quotedCarry = inQuotes ? ~uint64_t{0} : uint64_t{0};
+        for(; end - begin >= 64; begin += 64)
+        {
+            const auto low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+            const auto high = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin + 32));
+            const auto quoteMask = uint64_t((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, quotes)))
+                | uint64_t((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, quotes))) << 32;
+            const auto separatorMask = uint64_t((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, separators)))
+                | uint64_t((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, separators))) << 32;
+
+            const auto quoted = prefixXor(quoteMask) ^ quotedCarry;
+            if(const auto unquotedSeparators = separatorMask & ~quoted)
+            {
+                inQuotes = false;
+                return begin + countTrailingZeros(unquotedSeparators);
+            }
+            quotedCarry = broadcastLastBit(quoted);
+        }
+        inQuotes = quotedCarry != 0;
+        return findUnquotedSeparatorScalar(begin, end, recordSeparator, quote, inQuotes);
+    }
+
+    bool cpuSupportsAvx2()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if(info[0] < 7)
+            return false;
+
+        // AVX2 requires also the OS to preserve YMM registers
+        __cpuid(info, 1);
+        const bool osUsesXsave = info[2] & (1 << 27);
+        const bool hasAvx = info[2] & (1 << 28);
+        if(!osUsesXsave || !hasAvx || (_xgetbv(0) & 6) != 6)
+            return false;
+
+        __cpuidex(info, 7, 0);
+        return info[1] & (1 << 5);
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif // DFH_SIMD_X64
+
+    SimdLevel detectSimdLevel()
+    {
+#ifdef DFH_SIMD_X64
+        return cpuSupportsAvx2() ? SimdLevel::AVX2 : SimdLevel::SSE2;
+#else
+        return SimdLevel::Scalar;
+#endif
+    }
+
+    const SimdLevel detectedLevel = detectSimdLevel();
+    std::atomic<SimdLevel> activeLevel{detectedLevel};
+}
+
+SimdLevel detectedSimdLevel()
+{
+    return detectedLevel;
+}
+
+SimdLevel activeSimdLevel()
+{
+    return activeLevel.load(std::memory_order_relaxed);
+}
+
+void setSimdLevel(SimdLevel level)
+{
+    if(level > detectedLevel)
+        THROW("SIMD level {} is not supported, the best available is {}", (int)level, (int)detectedLevel);
+
+    activeLevel.store(level, std::memory_order_relaxed);
+}
+
+const char *findFirstOf(const char *begin, const char *end, char a, char b, char c)
+{
+    switch(activeSimdLevel())
+    {
+#ifdef DFH_SIMD_X64
+    case SimdLevel::AVX2: return findFirstOfAvx2(begin, end, a, b, c);
+    case SimdLevel::SSE2: return findFirstOfSse2(begin, end, a, b, c);
+#endif
+    default:              return findFirstOfScalar(begin, end, a, b, c);
+    }
+}
+
+const char *findUnquotedSeparator(const char *begin, const char *end, char recordSeparator, char quote, bool &inQuotes)
+{
+    switch(activeSimdLevel())
+    {
+#ifdef DFH_SIMD_X64
+    case SimdLevel::AVX2: return findUnquotedSeparatorAvx2(begin, end, recordSeparator, quote, inQuotes);
+    case SimdLevel::SSE2: return findUnquotedSeparatorSse2(begin, end, recordSeparator, quote, inQuotes);
+#endif
+    default:              return findUnquotedSeparatorScalar(begin, end, recordSeparator, quote, inQuotes);
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Core/Common.h"
+
+// Vectorized helpers for locating structural characters in CSV text.
+// The implementation is picked at runtime, depending on the instruction sets supported by CPU.
+
+enum class SimdLevel : int8_t
+{
+    Scalar, SSE2, AVX2
+};
+
+DFH_EXPORT SimdLevel detectedSimdLevel(); // the best level supported by both CPU and this build
+DFH_EXPORT SimdLevel activeSimdLevel();
+DFH_EXPORT void setSimdLevel(SimdLevel level); // meant for tests and benchmarks, throws if the level is not supported
+
+// Returns pointer to the first of characters a, b, c in [begin, end) or end if there is none.
+DFH_EXPORT const char *findFirstOf(const char *begin, const char *end, char a, char b, char c);
+
+// Returns pointer to the first record separator in [begin, end) that is not within quoted field, or end if there is none.
+// `inQuotes` tells whether `begin` is within quoted field. On return it tells the same about the returned position.
+// Note: quote characters are assumed to appear only in quoted fields (either delimiting them or escaped by doubling).
+DFH_EXPORT const char *findUnquotedSeparator(const char *begin, const char *end, char recordSeparator, char quote, bool &inQuotes);
+
+inline char *findFirstOf(char *begin, char *end, char a, char b, char c)
+{
+    return const_cast<char *>(findFirstOf(const_cast<const char *>(begin), end, a, b, c));
+}
+
+inline char *findUnquotedSeparator(char *begin, char *end, char recordSeparator, char quote, bool &inQuotes)
+{
+    return const_cast<char *>(findUnquotedSeparator(const_cast<const char *>(begin), end, recordSeparator, quote, inQuotes));
+}
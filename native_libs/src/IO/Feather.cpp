@@ -6,30 +6,62 @@
 #include <arrow/table.h>
 
 #include "Core/ArrowUtilities.h"
+#include "Core/LazyTable.h"
 
 std::string FormatFeather::fileSignature() const
 {
     return "FEA1";
 }
 
-std::shared_ptr<arrow::Table> FormatFeather::read(std::string_view filePath) const
+std::shared_ptr<arrow::Table> FormatFeather::read(std::string_view filePath, const FeatherReadOptions &options) const
 {
-    std::shared_ptr<arrow::io::ReadableFile> out;
-    checkStatus(arrow::io::ReadableFile::Open((std::string)filePath, &out));
+    // Memory-mapped file gives zero-copy reads: column buffers refer directly to the mapped pages
+    // (and keep the mapping alive for as long as they are used).
+    std::shared_ptr<arrow::io::MemoryMappedFile> out;
+    checkStatus(arrow::io::MemoryMappedFile::Open((std::string)filePath, arrow::io::FileMode::READ, &out));
 
     std::unique_ptr<arrow::ipc::feather::TableReader> reader;
     checkStatus(arrow::ipc::feather::TableReader::Open(out, &reader));
 
+    // Names come from the file metadata, so only the selected columns need to be fetched.
+    const auto names = transformToVector(iotaVector<int>(reader->num_columns()), [&] (int columnIndex)
+    {
+        return reader->GetColumnName(columnIndex);
+    });
+    const auto selectedColumns = selectColumnIndices(options.columns, names);
+
+    // Feather metadata describes column types only through the column readers, so a lazy table gets them upfront
+    // and creates its columns again on first access. Column buffers are slices of the mapping either way (pages are
+    // read when first touched and can be dropped by the system under memory pressure), so the lazy table saves
+    // neither memory nor IO over the eager one and keeps no memory budget: it only resolves columns on access.
+    if(options.lazy)
+    {
+        std::shared_ptr<arrow::ipc::feather::TableReader> sharedReader = std::move(reader);
+        const auto fields = transformToVector(selectedColumns, [&] (int columnIndex)
+        {
+            std::shared_ptr<arrow::Column> column;
+            checkStatus(sharedReader->GetColumn(columnIndex, &column));
+            return column->field();
+        });
+        auto loader = [sharedReader, selectedColumns] (int i)
+        {
+            std::shared_ptr<arrow::Column> column;
+            checkStatus(sharedReader->GetColumn(selectedColumns.at(i), &column));
+            return column;
+        };
+        return std::make_shared<LazyTable>(arrow::schema(fields), sharedReader->num_rows(), loader);
+    }
+
     std::vector<std::shared_ptr<arrow::Field>> fields;
     std::vector<std::shared_ptr<arrow::Column>> columns;
-    fields.resize(reader->num_columns());
-    columns.resize(reader->num_columns());
+    fields.resize(selectedColumns.size());
+    columns.resize(selectedColumns.size());
 
-    for(int columnIndex = 0; columnIndex < reader->num_columns(); columnIndex++)
+    for(size_t i = 0; i < selectedColumns.size(); i++)
     {
-        auto &columnTarget = columns.at(columnIndex);
-        checkStatus(reader->GetColumn(columnIndex, &columnTarget));
-        fields.at(columnIndex) = columnTarget->field();
+        auto &columnTarget = columns.at(i);
+        checkStatus(reader->GetColumn(selectedColumns[i], &columnTarget));
+        fields.at(i) = columnTarget->field();
     }
 
     auto schema = std::make_shared<arrow::Schema>(fields);
@@ -37,7 +69,7 @@ std::shared_ptr<arrow::Table> FormatFeather::read(std::string_view filePath) con
     return table;
 }
 
-void FormatFeather::write(std::string_view filePath, const arrow::Table &table) const
+void FormatFeather::write(std::string_view filePath, const arrow::Table &table, const FeatherWriteOptions &options) const
 {
     std::shared_ptr<arrow::io::FileOutputStream> out;
     checkStatus(arrow::io::FileOutputStream::Open((std::string)filePath, &out));
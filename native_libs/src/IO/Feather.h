@@ -11,10 +11,23 @@ namespace arrow
     class Table;
 }
 
-struct DFH_EXPORT FormatFeather : TableFileHandler
+struct FeatherReadOptions
 {
+    std::vector<ColumnSelector> columns = {}; // columns to be read, in the given order; empty means all
+    bool lazy = false; // if true, returns LazyTable resolving columns on first access (data is memory-mapped either way)
+};
+
+struct FeatherWriteOptions
+{
+};
+
+struct DFH_EXPORT FormatFeather : TableFileHandlerWithOptions<FeatherReadOptions, FeatherWriteOptions>
+{
+    using TableFileHandler::read;
+    using TableFileHandler::write;
+
     virtual std::string fileSignature() const override;
-    virtual std::shared_ptr<arrow::Table> read(std::string_view filePath) const override;
-    virtual void write(std::string_view filePath, const arrow::Table &table) const override;
+    virtual std::shared_ptr<arrow::Table> read(std::string_view filePath, const FeatherReadOptions &options) const override;
+    virtual void write(std::string_view filePath, const arrow::Table &table, const FeatherWriteOptions &options) const override;
     virtual std::vector<std::string> fileExtensions() const override;
 };
@@ -1,11 +1,20 @@
 #include "IO.h"
+#include "ArrowIPC.h"
+#include "Compression.h"
 #include "XLSX.h"
 #include "csv.h"
 #include "Feather.h"
+#include "JSONL.h"
+#include "Parquet.h"
+#include "Core/ArrowUtilities.h"
+#include "Core/Logger.h"
+#include "Core/Parallel.h"
 
 #if __cpp_lib_filesystem >= 201703
 #include <filesystem>
 #endif
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
@@ -15,6 +24,7 @@
 #include <arrow/table.h>
 
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/filesystem.hpp>
 
 namespace
 {
@@ -23,10 +33,130 @@ auto supportedFormatHandlers()
     std::vector<std::unique_ptr<TableFileHandler>> handlers;
     handlers.push_back(std::make_unique<FormatXLSX>());
     handlers.push_back(std::make_unique<FormatFeather>());
+    handlers.push_back(std::make_unique<FormatArrowIPC>());
+    handlers.push_back(std::make_unique<FormatParquet>());
+    handlers.push_back(std::make_unique<FormatJSONL>());
     handlers.push_back(std::make_unique<FormatCSV>());
     return handlers;
 }
 
+std::string formatName(const TableFileHandler &handler)
+{
+    return handler.fileExtensions().front();
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Handlers that might read the file, the most likely ones first.
+std::vector<std::unique_ptr<TableFileHandler>> candidateHandlers(std::string_view filepath, const FileHeader &header)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::pair<int, std::unique_ptr<TableFileHandler>>> scoredHandlers;
+    for(auto &&handler : supportedFormatHandlers())
+        if(const auto score = handler->compatibilityScore(filepath, header); score > 0)
+            scoredHandlers.emplace_back(score, std::move(handler));
+
+    // ties are resolved by the registration order
+    std::stable_sort(scoredHandlers.begin(), scoredHandlers.end(), [] (auto &&lhs, auto &&rhs) { return lhs.first > rhs.first; });
+    auto handlers = transformToVector(scoredHandlers, [] (auto &&scoredHandler) { return std::move(scoredHandler.second); });
+    LOG("detected {} candidate formats for {} in {} ms, the best is {}", handlers.size(), filepath, millisecondsSince(start), handlers.empty() ? "none"s : formatName(*handlers.front()));
+    return handlers;
+}
+
+// Reads file with the handler. Handlers that decompress files get the compression found in the header,
+// so they don't open the file once more to detect it. CSV files are read with the given options.
+std::shared_ptr<arrow::Table> readWithHandler(const TableFileHandler &handler, std::string_view filepath, const FileHeader &header, CsvReadOptions csvOptions = {})
+{
+    if(auto csvHandler = dynamic_cast<const FormatCSV *>(&handler))
+    {
+        csvOptions.compression = header.compression;
+        return csvHandler->read(filepath, csvOptions);
+    }
+    if(auto jsonlHandler = dynamic_cast<const FormatJSONL *>(&handler))
+    {
+        JsonlReadOptions options;
+        options.compression = header.compression;
+        return jsonlHandler->read(filepath, options);
+    }
+    return handler.read(filepath);
+}
+
+// Tries reading file with consecutive candidate handlers until one succeeds. The file header is read once and shared by all of them.
+template<typename ReadFunction>
+std::shared_ptr<arrow::Table> readWithCandidateHandlers(std::string_view filepath, ReadFunction &&readWith)
+{
+    const auto header = FileHeader::read(filepath);
+    for(auto &&handler : candidateHandlers(filepath, header))
+    {
+        const auto start = std::chrono::steady_clock::now();
+        try
+        {
+            auto table = readWith(*handler, header);
+            LOG("read {} as {} in {} ms", filepath, formatName(*handler), millisecondsSince(start));
+            return table;
+        }
+        catch(CannotOpenToRead &)
+        {
+            // this is a serious one -- there is no sense in trying reading something that cannot be read anyway
+            throw;
+        }
+        catch(std::exception &e)
+        {
+            LOG("reading {} as {} failed after {} ms: {}", filepath, formatName(*handler), millisecondsSince(start), e.what());
+        }
+    }
+
+    THROW("Failed to load file {}: it doesn't parse with default settings as any of the supported formats", filepath);
+}
+
+// Reads file like `readTableFromFile` but CSV files get the given column types instead of deducing them.
+std::shared_ptr<arrow::Table> readTableFromFileWithTypes(std::string_view filepath, const std::vector<ColumnType> &columnTypes)
+{
+    return readWithCandidateHandlers(filepath, [&] (const TableFileHandler &handler, const FileHeader &header)
+    {
+        CsvReadOptions options;
+        options.columnTypes = columnTypes;
+        return readWithHandler(handler, filepath, header, options);
+    });
+}
+
+// Matches whole text against pattern, where `*` stands for any sequence of characters and `?` for any single character.
+bool matchesWildcards(std::string_view text, std::string_view pattern)
+{
+    size_t textPos = 0, patternPos = 0;
+    auto starPos = std::string_view::npos; // position of the last star in pattern
+    size_t starMatchEnd = 0; // end of text matched by the last star so far
+    while(textPos < text.size())
+    {
+        if(patternPos < pattern.size() && (pattern[patternPos] == '?' || pattern[patternPos] == text[textPos]))
+        {
+            ++textPos;
+            ++patternPos;
+        }
+        else if(patternPos < pattern.size() && pattern[patternPos] == '*')
+        {
+            starPos = patternPos++;
+            starMatchEnd = textPos;
+        }
+        else if(starPos != std::string_view::npos)
+        {
+            // backtrack: let the last star consume one more character
+            patternPos = starPos + 1;
+            textPos = ++starMatchEnd;
+        }
+        else
+            return false;
+    }
+
+    while(patternPos < pattern.size() && pattern[patternPos] == '*')
+        ++patternPos;
+    return patternPos == pattern.size();
+}
+
 std::vector<std::string> defaultColumnNames(int count)
 {
     std::vector<std::string> ret;
@@ -65,6 +195,28 @@ std::vector<std::string> decideColumnNames(int count, const HeaderPolicy &policy
     return ret;
 }
 
+std::vector<int> selectColumnIndices(const std::vector<ColumnSelector> &selection, const std::vector<std::string> &names)
+{
+    if(selection.empty())
+        return iotaVector<int>(names.size());
+
+    return transformToVector(selection, [&] (const ColumnSelector &selector)
+    {
+        if(auto index = get_if<int>(&selector))
+        {
+            if(*index < 0 || *index >= names.size())
+                THROW("Cannot select column #{}: there are {} columns", *index, names.size());
+            return *index;
+        }
+
+        const auto &name = get<std::string>(selector);
+        const auto itr = std::find(names.begin(), names.end(), name);
+        if(itr == names.end())
+            THROW("Cannot select column `{}`: there is no such column", name);
+        return (int)std::distance(names.begin(), itr);
+    });
+}
+
 std::shared_ptr<arrow::Table> buildTable(std::vector<std::string> names, std::vector<std::shared_ptr<arrow::Array>> arrays, std::vector<ColumnType> columnTypes)
 {
     std::vector<std::shared_ptr<arrow::Field>> fields;
@@ -80,13 +232,32 @@ std::shared_ptr<arrow::Table> buildTable(std::vector<std::string> names, std::ve
     return table;
 }
 
-std::shared_ptr<arrow::Table> readTableFromFile(std::string_view filepath)
+std::shared_ptr<arrow::Table> buildTable(std::vector<std::string> names, std::vector<std::shared_ptr<arrow::ChunkedArray>> arrays, std::vector<ColumnType> columnTypes)
 {
-    for(auto &&handler : supportedFormatHandlers())
-        if(auto table = handler->tryReading(filepath))
-            return table;
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    std::vector<std::shared_ptr<arrow::Column>> columns;
+    for(int column = 0; column < arrays.size(); column++)
+    {
+        const auto array = arrays.at(column);
+        const auto nullable = array->null_count() > 0 || columnTypes.at(column).nullable;
+        auto field = std::make_shared<arrow::Field>(names.at(column), columnTypes.at(column).type, nullable);
+        fields.push_back(field);
+        columns.push_back(std::make_shared<arrow::Column>(field, array));
+    }
 
-    THROW("Failed to load file {}: it doesn't parse with default settings as any of the supported formats", filepath);
+    auto schema = std::make_shared<arrow::Schema>(fields);
+    auto table = arrow::Table::Make(schema, columns);
+    return table;
+}
+
+std::shared_ptr<arrow::Table> readTableFromFile(std::string_view filepath, LoadProgress *progress /*= nullptr*/)
+{
+    return readWithCandidateHandlers(filepath, [&] (const TableFileHandler &handler, const FileHeader &header)
+    {
+        CsvReadOptions options;
+        options.progress = progress;
+        return readWithHandler(handler, filepath, header, options);
+    });
 }
 
 void writeTableToFile(std::string_view filepath, const arrow::Table &table)
@@ -98,6 +269,81 @@ void writeTableToFile(std::string_view filepath, const arrow::Table &table)
     THROW("cannot write table to {}: cannot deduce format type from extension", filepath);
 }
 
+std::vector<std::string> expandFilePattern(std::string_view pattern)
+{
+    const auto separatorPos = pattern.find_last_of("/\\");
+    const auto directoryPart = separatorPos == std::string_view::npos ? std::string_view{} : pattern.substr(0, separatorPos + 1);
+    const auto namePattern = pattern.substr(directoryPart.size());
+    if(namePattern.find_first_of("*?") == std::string_view::npos)
+        return { std::string(pattern) };
+    if(directoryPart.find_first_of("*?") != std::string_view::npos)
+        THROW("Cannot expand pattern {}: wildcards are allowed only in file name", pattern);
+
+    const auto directory = directoryPart.empty() ? boost::filesystem::path(".") : boost::filesystem::path(std::string(directoryPart));
+    if(!boost::filesystem::is_directory(directory))
+        THROW("Cannot expand pattern {}: there is no directory {}", pattern, directory.string());
+
+    std::vector<std::string> ret;
+    for(auto &&entry : boost::filesystem::directory_iterator(directory))
+    {
+        const auto name = entry.path().filename().string();
+        if(boost::filesystem::is_regular_file(entry.status()) && matchesWildcards(name, namePattern))
+            ret.push_back(std::string(directoryPart) + name);
+    }
+
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
+std::shared_ptr<arrow::Table> readTablesFromFiles(const std::vector<std::string> &filePaths, int threadCount /*= 0*/)
+{
+    if(filePaths.empty())
+        THROW("Cannot read tables: no files were given");
+
+    // Other files can be read only once the first one established the schema.
+    std::vector<std::shared_ptr<arrow::Table>> tables(filePaths.size());
+    tables[0] = readTableFromFile(filePaths[0]);
+
+    const auto &schema = *tables[0]->schema();
+    const auto columnTypes = transformToVector(schema.fields(), [] (auto &&field)
+    {
+        return ColumnType{ field->type(), field->nullable(), true };
+    });
+    parallelFor(filePaths.size() - 1, threadCount, [&] (int64_t i)
+    {
+        tables[i + 1] = readTableFromFileWithTypes(filePaths[i + 1], columnTypes);
+    });
+
+    // checked here only to tell which files differ
+    for(size_t i = 1; i < tables.size(); i++)
+    {
+        const auto &table = *tables[i];
+        if(table.num_columns() != schema.num_fields())
+            THROW("File {} has {} columns, while {} has {}", filePaths[i], table.num_columns(), filePaths[0], schema.num_fields());
+
+        for(int column = 0; column < schema.num_fields(); column++)
+        {
+            const auto &field = *table.schema()->field(column);
+            const auto &expectedField = *schema.field(column);
+            if(field.name() != expectedField.name())
+                THROW("Column #{} of file {} is named `{}`, while in {} it is `{}`", column, filePaths[i], field.name(), filePaths[0], expectedField.name());
+            if(!field.type()->Equals(expectedField.type()))
+                THROW("Column `{}` of file {} has type {}, while in {} it has {}", field.name(), filePaths[i], field.type()->ToString(), filePaths[0], expectedField.type()->ToString());
+        }
+    }
+
+    return concatenateTables(tables);
+}
+
+std::shared_ptr<arrow::Table> readTablesFromFiles(std::string_view pattern, int threadCount /*= 0*/)
+{
+    const auto filePaths = expandFilePattern(pattern);
+    if(filePaths.empty())
+        THROW("Cannot read tables: no files match pattern {}", pattern);
+
+    return readTablesFromFiles(filePaths, threadCount);
+}
+
 std::ofstream openFileToWrite(std::string_view filepath)
 {
     // what we care about is mostly MSVC because on Windows paths are not utf-8 by default
@@ -200,19 +446,51 @@ std::shared_ptr<arrow::Table> TableFileHandler::tryReading(std::string_view file
     }
 }
 
-bool TableFileHandler::fileMightBeCompatible(std::string_view filePath) const
+FileHeader FileHeader::read(std::string_view filePath)
 {
-    auto expectedSignature = fileSignature();
     auto input = openFileToRead(filePath);
 
-    std::string buffer(expectedSignature.size(), '\0');
-    input.read(buffer.data(), buffer.size());
-    bool readOk = !!input;
+    FileHeader header;
+    header.bytes.resize(maxLength);
+    input.read(header.bytes.data(), maxLength);
+    header.bytes.resize(input.gcount());
+
+    header.compression = detectCompression(header.bytes, filePath);
+    if(header.compression == Compression::None)
+        return header;
 
-    // restore pristine input state
-    input.clear();
-    input.seekg(0);
-    return readOk && expectedSignature == buffer;
+    // signatures are to be matched against the decompressed contents
+    try
+    {
+        input.clear();
+        input.seekg(0);
+        DecompressingReader reader{std::move(input), header.compression};
+        header.bytes.resize(maxLength);
+        header.bytes.resize(reader.read(header.bytes.data(), maxLength));
+    }
+    catch(std::exception &)
+    {
+        // corrupted data or compression not supported by this build: no format will be recognized by signature
+        header.bytes.clear();
+    }
+    return header;
+}
+
+int TableFileHandler::compatibilityScore(std::string_view filePath, const FileHeader &header) const
+{
+    if(header.compression != Compression::None && !readsCompressedFiles())
+        return 0;
+
+    const auto signature = fileSignature();
+    if(!boost::starts_with(header.bytes, signature))
+        return 0;
+
+    return 1 + (signature.empty() ? 0 : 2) + (filePathExtensionMatches(filePath) ? 1 : 0);
+}
+
+bool TableFileHandler::fileMightBeCompatible(std::string_view filePath) const
+{
+    return compatibilityScore(filePath, FileHeader::read(filePath)) > 0;
 }
 
 bool TableFileHandler::filePathExtensionMatches(std::string_view filePath) const
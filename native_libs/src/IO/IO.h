@@ -11,6 +11,7 @@
 #include "variant.h"
 
 #include "Core/Common.h"
+#include "Compression.h"
 
 namespace arrow
 {
@@ -19,6 +20,8 @@ namespace arrow
     class DataType;
 }
 
+struct LoadProgress;
+
 struct CannotOpenToRead : std::runtime_error
 {
     CannotOpenToRead(std::string_view path)
@@ -31,6 +34,8 @@ struct GenerateColumnNames {};
 
 using HeaderPolicy = variant<TakeFirstRowAsHeaders, GenerateColumnNames, std::vector<std::string>>;
 
+using ColumnSelector = variant<int, std::string>; // column index or column name
+
 struct DFH_EXPORT ColumnType
 {
     std::shared_ptr<arrow::DataType> type;
@@ -74,15 +79,40 @@ inline constexpr auto defaultValue()
 }
 
 std::vector<std::string> decideColumnNames(int count, const HeaderPolicy &policy, std::function<std::string(int)> readHeaderCell);
+// Returns indices of the selected columns, in the selection order. Empty selection means all columns. Throws on unknown column.
+std::vector<int> selectColumnIndices(const std::vector<ColumnSelector> &selection, const std::vector<std::string> &names);
 std::shared_ptr<arrow::Table> buildTable(std::vector<std::string> names, std::vector<std::shared_ptr<arrow::Array>> arrays, std::vector<ColumnType> columnTypes);
+std::shared_ptr<arrow::Table> buildTable(std::vector<std::string> names, std::vector<std::shared_ptr<arrow::ChunkedArray>> arrays, std::vector<ColumnType> columnTypes);
 
-DFH_EXPORT std::shared_ptr<arrow::Table> readTableFromFile(std::string_view filepath);
+// If `progress` is given, CSV files report parsing progress to it and poll it for cancellation.
+DFH_EXPORT std::shared_ptr<arrow::Table> readTableFromFile(std::string_view filepath, LoadProgress *progress = nullptr);
 DFH_EXPORT void writeTableToFile(std::string_view filepath, const arrow::Table &table);
+
+// Returns paths of files matching the pattern, sorted by name. Wildcards `*` and `?` may be used only in the file name part.
+// Pattern without wildcards is returned as it is.
+DFH_EXPORT std::vector<std::string> expandFilePattern(std::string_view pattern);
+
+// Reads files of the same structure into a single table. Chunks of the per-file columns are not copied but become chunks of the result.
+// Files are read concurrently by `threadCount` threads (0 uses all hardware threads). The first file determines the schema:
+// CSV files are read using its column types, other formats must yield the same types. Throws if column names or types differ.
+DFH_EXPORT std::shared_ptr<arrow::Table> readTablesFromFiles(const std::vector<std::string> &filePaths, int threadCount = 0);
+DFH_EXPORT std::shared_ptr<arrow::Table> readTablesFromFiles(std::string_view pattern, int threadCount = 0); // reads files matching the pattern
 DFH_EXPORT std::ofstream openFileToWrite(std::string_view filepath);
 DFH_EXPORT void writeFile(std::string_view, std::string_view contents);
 DFH_EXPORT std::ifstream openFileToRead(std::string_view filepath);
 DFH_EXPORT std::string getFileContents(std::string_view filepath);
 
+// First bytes of a file (of its decompressed contents, if it is compressed), read once to tell which handlers might read it.
+struct DFH_EXPORT FileHeader
+{
+    static constexpr size_t maxLength = 64;
+
+    Compression compression = Compression::None;
+    std::string bytes; // shorter than `maxLength` only if the file is
+
+    static FileHeader read(std::string_view filePath); // throws CannotOpenToRead
+};
+
 // Basic interface for classes that perform table IO for specific file formats
 struct TableFileHandler
 {
@@ -92,9 +122,14 @@ struct TableFileHandler
     virtual std::shared_ptr<arrow::Table> read(std::string_view filePath) const = 0;  // throws on failure
     virtual void write(std::string_view filePath, const arrow::Table &table) const = 0;
     virtual std::vector<std::string> fileExtensions() const = 0;
+    virtual bool readsCompressedFiles() const { return false; } // whether gzip and zstd files are decompressed when read
+
+    // Zero if the file certainly cannot be read by this handler. Otherwise the higher score, the more likely it is the file format:
+    // non-empty signature matching the header is a strong hint, matching file extension a weak one.
+    virtual int compatibilityScore(std::string_view filePath, const FileHeader &header) const;
 
     std::shared_ptr<arrow::Table> tryReading(std::string_view filePath) const; // returns nullptr on failure
-    bool fileMightBeCompatible(std::string_view filePath) const; // might give false positive (just checks signature)
+    bool fileMightBeCompatible(std::string_view filePath) const; // might give false positive (just checks signature, of decompressed contents for compressed files)
     bool filePathExtensionMatches(std::string_view filePath) const;
 };
 
@@ -0,0 +1,537 @@
+#include "JSONL.h"
+#include "IO.h"
+#include "Compression.h"
+#include "MappedFile.h"
+#include "Core/ArrowUtilities.h"
+#include "Core/Error.h"
+#include "Core/Parallel.h"
+#include "Core/Utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+#include <arrow/builder.h>
+#include <arrow/table.h>
+
+#include <rapidjson/error/en.h>
+#include <rapidjson/memorystream.h>
+#include <rapidjson/reader.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+namespace
+{
+    // ISO 8601 date and time, `YYYY-MM-DDTHH:MM:SS`, followed by the fraction of second if it is not zero
+    // (in milli-, micro- or nanoseconds, whichever is enough). Read back by `parseTimestamp`.
+    std::string formatIsoTimestamp(Timestamp timestamp)
+    {
+        const auto day = date::floor<date::days>(timestamp);
+        const auto ymd = date::year_month_day{day};
+        const auto sinceMidnight = TimestampDuration(timestamp - day).count();
+        const auto seconds = sinceMidnight / 1'000'000'000;
+        auto text = fmt::format("{:04}-{:02}-{:02}T{:02}:{:02}:{:02}", (int)ymd.year(), (unsigned)ymd.month(), (unsigned)ymd.day(),
+            seconds / 3600, seconds / 60 % 60, seconds % 60);
+
+        auto fraction = sinceMidnight % 1'000'000'000;
+        if(fraction)
+        {
+            int digits = 9;
+            for(; fraction % 1000 == 0; digits -= 3)
+                fraction /= 1000;
+            text += fmt::format(".{:0{}}", fraction, digits);
+        }
+        return text;
+    }
+
+    // Numbers are passed to handlers as text, so they can be parsed according to the column type.
+    constexpr auto parseFlags = rapidjson::kParseStopWhenDoneFlag | rapidjson::kParseNumbersAsStringsFlag;
+
+    bool isJsonWhitespace(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    int64_t lineNumberAt(std::string_view data, size_t offset)
+    {
+        return 1 + std::count(data.begin(), data.begin() + std::min(offset, data.size()), '\n');
+    }
+
+    // Feeds records from data to the handler, at most `maxRecordCount` of them (-1 means all).
+    // Offset of data within the whole input is used only for error messages.
+    template<typename Handler>
+    void parseRecords(std::string_view data, size_t dataOffset, Handler &handler, std::string_view wholeData, int64_t maxRecordCount = -1)
+    {
+        rapidjson::MemoryStream stream{data.data(), data.size()};
+        rapidjson::Reader reader;
+        for(int64_t record = 0; record != maxRecordCount; record++)
+        {
+            while(isJsonWhitespace(stream.Peek()))
+                stream.Take();
+            if(stream.Tell() == data.size())
+                return;
+
+            const auto recordStart = stream.Tell();
+            const auto result = reader.Parse<parseFlags>(stream, handler);
+            if(handler.notAnObject)
+                THROW("JSON Lines record at line {} is not an object", lineNumberAt(wholeData, dataOffset + recordStart));
+            if(result.IsError())
+                THROW("Failed to parse JSON Lines record at line {}: {}", lineNumberAt(wholeData, dataOffset + result.Offset()), rapidjson::GetParseError_En(result.Code()));
+        }
+    }
+
+    // Tracks position within a record: only values directly under the top-level object are of interest.
+    template<typename Derived>
+    struct RecordHandlerBase : rapidjson::BaseReaderHandler<rapidjson::UTF8<>, Derived>
+    {
+        int depth = 0; // of objects and arrays
+        bool notAnObject = false;
+
+        bool StartObject()
+        {
+            if(depth++ == 0)
+                static_cast<Derived &>(*this).startRecord();
+            return true;
+        }
+        bool EndObject(rapidjson::SizeType)
+        {
+            if(--depth == 0)
+                static_cast<Derived &>(*this).endRecord();
+            return true;
+        }
+        bool StartArray()
+        {
+            if(depth == 0)
+                return !(notAnObject = true);
+            ++depth;
+            return true;
+        }
+        bool EndArray(rapidjson::SizeType)
+        {
+            --depth;
+            return true;
+        }
+        bool Key(const char *text, rapidjson::SizeType length, bool)
+        {
+            if(depth == 1)
+                static_cast<Derived &>(*this).key(std::string_view{text, length});
+            return true;
+        }
+
+        bool Null()
+        {
+            return depth != 0 || !(notAnObject = true);
+        }
+        bool Bool(bool value)
+        {
+            if(depth == 0)
+                return !(notAnObject = true);
+            if(depth == 1)
+                static_cast<Derived &>(*this).boolean(value);
+            return true;
+        }
+        bool RawNumber(const char *text, rapidjson::SizeType length, bool)
+        {
+            if(depth == 0)
+                return !(notAnObject = true);
+            if(depth == 1)
+                static_cast<Derived &>(*this).text(std::string_view{text, length}, false);
+            return true;
+        }
+        bool String(const char *text, rapidjson::SizeType length, bool)
+        {
+            if(depth == 0)
+                return !(notAnObject = true);
+            if(depth == 1)
+                static_cast<Derived &>(*this).text(std::string_view{text, length}, true);
+            return true;
+        }
+    };
+
+    struct DeducedColumn
+    {
+        std::string name;
+        bool sawInteger = false;
+        bool sawDouble = false;
+        bool sawString = false;
+        bool allStringsAreTimestamps = true;
+
+        TypePtr type() const
+        {
+            if(sawString)
+                return allStringsAreTimestamps && !sawInteger && !sawDouble
+                    ? getTypeSingleton<arrow::Type::TIMESTAMP>()
+                    : getTypeSingleton<arrow::Type::STRING>();
+            if(sawDouble)
+                return getTypeSingleton<arrow::Type::DOUBLE>();
+            if(sawInteger)
+                return getTypeSingleton<arrow::Type::INT64>();
+            return getTypeSingleton<arrow::Type::STRING>(); // only nulls or nested values
+        }
+    };
+
+    struct TypeDeductionHandler : RecordHandlerBase<TypeDeductionHandler>
+    {
+        std::vector<DeducedColumn> columns; // in order of the first appearance
+        std::unordered_map<std::string, int> columnIndices;
+        DeducedColumn *current = nullptr;
+
+        void startRecord() {}
+        void endRecord() {}
+        void key(std::string_view name)
+        {
+            auto [itr, inserted] = columnIndices.try_emplace(std::string(name), (int)columns.size());
+            if(inserted)
+                columns.push_back(DeducedColumn{ std::string(name) });
+            current = &columns[itr->second];
+        }
+        void boolean(bool)
+        {
+            current->sawInteger = true;
+        }
+        void text(std::string_view value, bool isString)
+        {
+            if(isString)
+            {
+                current->sawString = true;
+                current->allStringsAreTimestamps = current->allStringsAreTimestamps && Parser::as<Timestamp>(value).has_value();
+            }
+            else if(Parser::as<int64_t>(value))
+                current->sawInteger = true;
+            else
+                current->sawDouble = true;
+        }
+    };
+
+    struct JsonColumnBuilderBase
+    {
+        int64_t length = 0; // records that have the value added
+
+        virtual ~JsonColumnBuilderBase() = default;
+        virtual void addText(std::string_view value, bool isString) = 0;
+        virtual void addBoolean(bool value) = 0;
+        virtual void addMissing() = 0;
+        virtual std::shared_ptr<arrow::Array> finish() = 0;
+    };
+
+    template<arrow::Type::type id>
+    struct JsonColumnBuilder : JsonColumnBuilderBase
+    {
+        std::shared_ptr<BuilderFor<id>> builder = makeBuilder(getTypeSingleton<id>());
+
+        virtual void addText(std::string_view value, bool isString) override
+        {
+            if constexpr(id == arrow::Type::STRING)
+                checkStatus(builder->Append(value.data(), (int32_t)value.size()));
+            else if(const auto parsed = Parser::as<typename TypeDescription<id>::ValueType>(value))
+                checkStatus(append(*builder, *parsed));
+            else
+                checkStatus(builder->AppendNull());
+        }
+        virtual void addBoolean(bool value) override
+        {
+            if constexpr(id == arrow::Type::STRING)
+                checkStatus(append(*builder, value ? "true"sv : "false"sv));
+            else if constexpr(id == arrow::Type::TIMESTAMP)
+                checkStatus(builder->AppendNull());
+            else
+                checkStatus(builder->Append(value));
+        }
+        virtual void addMissing() override
+        {
+            checkStatus(builder->AppendNull());
+        }
+        virtual std::shared_ptr<arrow::Array> finish() override
+        {
+            return ::finish(*builder);
+        }
+    };
+
+    struct RecordBuildingHandler : RecordHandlerBase<RecordBuildingHandler>
+    {
+        std::unordered_map<std::string_view, int> builderIndices; // column name => builder
+        std::vector<std::unique_ptr<JsonColumnBuilderBase>> builders;
+        JsonColumnBuilderBase *current = nullptr; // builder for the value of the last key, nullptr if not wanted
+        int64_t recordCount = 0;
+
+        RecordBuildingHandler(const std::vector<std::string> &names, const std::vector<TypePtr> &types)
+        {
+            for(size_t i = 0; i < names.size(); i++)
+            {
+                builderIndices[names[i]] = (int)i;
+                builders.push_back(visitType(*types[i], [&] (auto id) -> std::unique_ptr<JsonColumnBuilderBase>
+                {
+                    return std::make_unique<JsonColumnBuilder<id.value>>();
+                }));
+            }
+        }
+
+        void startRecord()
+        {
+            current = nullptr;
+        }
+        void endRecord()
+        {
+            // absent keys (and nulls) leave the column without value in this record
+            ++recordCount;
+            for(auto &builder : builders)
+            {
+                if(builder->length < recordCount)
+                {
+                    builder->addMissing();
+                    ++builder->length;
+                }
+            }
+        }
+        void key(std::string_view name)
+        {
+            current = nullptr;
+            if(auto itr = builderIndices.find(name); itr != builderIndices.end())
+            {
+                auto builder = builders[itr->second].get();
+                if(builder->length == recordCount) // for repeated keys, the first value is kept
+                    current = builder;
+            }
+        }
+        void boolean(bool value)
+        {
+            if(current)
+            {
+                current->addBoolean(value);
+                ++current->length;
+                current = nullptr;
+            }
+        }
+        void text(std::string_view value, bool isString)
+        {
+            if(current)
+            {
+                current->addText(value, isString);
+                ++current->length;
+                current = nullptr;
+            }
+        }
+    };
+
+    // Splits data into parts of roughly equal size, each ending at a line end (or data end).
+    std::vector<std::string_view> splitOnLines(std::string_view data, int partCount)
+    {
+        std::vector<std::string_view> parts;
+        size_t partStart = 0;
+        for(int i = 1; i <= partCount && partStart < data.size(); i++)
+        {
+            auto partEnd = i == partCount ? data.size() : std::max(partStart, data.size() * i / partCount);
+            partEnd = std::min(data.find('\n', partEnd), data.size());
+            if(partEnd < data.size())
+                ++partEnd; // the newline belongs to the record
+            parts.push_back(data.substr(partStart, partEnd - partStart));
+            partStart = partEnd;
+        }
+        return parts;
+    }
+
+    std::shared_ptr<arrow::Table> readJsonl(std::string_view data, const JsonlReadOptions &options)
+    {
+        if(options.typeDeductionDepth <= 0)
+            THROW("type deduction depth must be positive, got {}", options.typeDeductionDepth);
+
+        TypeDeductionHandler deduction;
+        parseRecords(data, 0, deduction, data, options.typeDeductionDepth);
+
+        const auto names = transformToVector(deduction.columns, [] (auto &&column) { return column.name; });
+        const auto selectedColumns = selectColumnIndices(options.columns, names);
+        const auto selectedNames = transformToVector(selectedColumns, [&] (int column) { return names[column]; });
+        const auto selectedTypes = transformToVector(selectedColumns, [&] (int column) { return deduction.columns[column].type(); });
+
+        // Valid JSON has no raw newlines within values, so each line can be parsed independently.
+        const auto parts = splitOnLines(data, resolveThreadCount(options.threadCount));
+        std::vector<std::vector<std::shared_ptr<arrow::Array>>> partArrays(parts.size());
+        parallelFor(parts.size(), options.threadCount, [&] (int64_t i)
+        {
+            RecordBuildingHandler handler{selectedNames, selectedTypes};
+            parseRecords(parts[i], parts[i].data() - data.data(), handler, data);
+            partArrays[i] = transformToVector(handler.builders, [] (auto &&builder) { return builder->finish(); });
+        });
+
+        std::vector<std::shared_ptr<arrow::ChunkedArray>> arrays;
+        for(size_t column = 0; column < selectedColumns.size(); column++)
+        {
+            std::vector<std::shared_ptr<arrow::Array>> chunks;
+            for(auto &&part : partArrays)
+                chunks.push_back(part[column]);
+            arrays.push_back(std::make_shared<arrow::ChunkedArray>(chunks, selectedTypes[column]));
+        }
+
+        const auto columnTypes = transformToVector(selectedTypes, [] (auto &&type) { return ColumnType{ type, false, true }; });
+        return buildTable(selectedNames, arrays, columnTypes);
+    }
+
+    // JSON-encoded values of a single column within a range of rows (similarly to CSV writer).
+    struct FormattedColumn
+    {
+        std::string prefix; // separator and encoded key, written before each non-null value
+        std::string text;
+        std::vector<size_t> valueEnds; // [row] => end of the row's value in `text`, it starts where the previous one ends
+    };
+
+    template<arrow::Type::type id>
+    void formatValues(const arrow::Array &array, FormattedColumn &out)
+    {
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer;
+        iterateOver<id>(array,
+            [&] (auto &&value)
+            {
+                buffer.Clear();
+                writer.Reset(buffer);
+                if constexpr(id == arrow::Type::STRING)
+                    writer.String(value.data(), (rapidjson::SizeType)value.size());
+                else if constexpr(id == arrow::Type::INT64)
+                    writer.Int64(value);
+                else if constexpr(id == arrow::Type::DOUBLE)
+                {
+                    if(std::isfinite(value))
+                        writer.Double(value);
+                    else
+                        writer.Null(); // JSON has no representation for NaN and infinities
+                }
+                else if constexpr(id == arrow::Type::TIMESTAMP)
+                {
+                    const auto text = formatIsoTimestamp(value);
+                    writer.String(text.data(), (rapidjson::SizeType)text.size());
+                }
+                else
+                    throw std::runtime_error("wrong type");
+
+                out.text.append(buffer.GetString(), buffer.GetSize());
+                out.valueEnds.push_back(out.text.size());
+            },
+            [&]
+            {
+                out.valueEnds.push_back(out.text.size());
+            });
+    }
+
+    // Formats records of rows [beginRow, endRow), each followed by a newline. Null values are omitted.
+    std::string formatJsonlRows(const arrow::Table &table, int64_t beginRow, int64_t endRow)
+    {
+        std::vector<FormattedColumn> columns(table.num_columns());
+        for(int column = 0; column < table.num_columns(); column++)
+        {
+            auto &formatted = columns[column];
+            rapidjson::StringBuffer key;
+            rapidjson::Writer<rapidjson::StringBuffer> writer{key};
+            const auto name = table.column(column)->name();
+            writer.String(name.data(), (rapidjson::SizeType)name.size());
+            formatted.prefix = std::string(",") + key.GetString() + ":";
+
+            formatted.valueEnds.reserve(endRow - beginRow);
+            const auto slice = table.column(column)->Slice(beginRow, endRow - beginRow);
+            for(auto &chunk : slice->data()->chunks())
+            {
+                const auto decoded = chunk->type_id() == arrow::Type::DICTIONARY ? decodeDictionary(chunk) : chunk;
+                visitType(*decoded->type(), [&] (auto id) { formatValues<id.value>(*decoded, formatted); });
+            }
+        }
+
+        std::string out;
+        for(int64_t row = 0; row < endRow - beginRow; row++)
+        {
+            out += '{';
+            bool first = true;
+            for(auto &formatted : columns)
+            {
+                const auto valueStart = row ? formatted.valueEnds[row - 1] : 0;
+                const auto valueLength = formatted.valueEnds[row] - valueStart;
+                if(valueLength == 0)
+                    continue;
+
+                out.append(formatted.prefix, first ? 1 : 0, std::string::npos);
+                out.append(formatted.text, valueStart, valueLength);
+                first = false;
+            }
+            out += "}\n";
+        }
+        return out;
+    }
+
+    void generateJsonl(std::ostream &out, const arrow::Table &table, int threadCount)
+    {
+        constexpr int64_t rowsPerBlock = 16384;
+        const auto rowCount = table.num_rows();
+        const auto blockCount = (rowCount + rowsPerBlock - 1) / rowsPerBlock;
+
+        // Blocks are formatted in batches, so only a batch of formatted text is kept in memory at once.
+        const auto batchBlockCount = std::max<int64_t>(1, resolveThreadCount(threadCount)) * 4;
+        for(int64_t batchStart = 0; batchStart < blockCount; batchStart += batchBlockCount)
+        {
+            const auto blocksInBatch = std::min(batchBlockCount, blockCount - batchStart);
+            std::vector<std::string> formatted(blocksInBatch);
+            parallelFor(blocksInBatch, threadCount, [&] (int64_t i)
+            {
+                const auto beginRow = (batchStart + i) * rowsPerBlock;
+                const auto endRow = std::min(beginRow + rowsPerBlock, rowCount);
+                formatted[i] = formatJsonlRows(table, beginRow, endRow);
+            });
+            for(auto &text : formatted)
+                out.write(text.data(), text.size());
+        }
+    }
+}
+
+std::shared_ptr<arrow::Table> FormatJSONL::readString(std::string_view data, const JsonlReadOptions &options) const
+{
+    return readJsonl(data, options);
+}
+
+std::string FormatJSONL::writeToString(const arrow::Table &table, const JsonlWriteOptions &options) const
+{
+    std::ostringstream out;
+    generateJsonl(out, table, options.threadCount);
+    return out.str();
+}
+
+std::string FormatJSONL::fileSignature() const
+{
+    // each record is an object
+    return "{";
+}
+
+std::shared_ptr<arrow::Table> FormatJSONL::read(std::string_view filePath, const JsonlReadOptions &options) const
+{
+    try
+    {
+        const auto compression = options.compression ? *options.compression : detectCompression(filePath);
+        if(compression != Compression::None)
+            return readJsonl(getDecompressedFileContents(filePath, compression), options);
+
+        const MappedFile file{filePath};
+        return readJsonl(file.view(), options);
+    }
+    catch(CannotOpenToRead &)
+    {
+        throw;
+    }
+    catch(std::exception &e)
+    {
+        THROW("Failed to load file {} as JSON Lines: {}", filePath, e);
+    }
+}
+
+void FormatJSONL::write(std::string_view filePath, const arrow::Table &table, const JsonlWriteOptions &options) const
+{
+    auto out = openFileToWrite(filePath);
+    generateJsonl(out, table, options.threadCount);
+}
+
+std::vector<std::string> FormatJSONL::fileExtensions() const
+{
+    return { "jsonl", "ndjson" };
+}
+
+bool FormatJSONL::readsCompressedFiles() const
+{
+    return true;
+}
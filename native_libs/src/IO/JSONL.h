@@ -0,0 +1,50 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Core/Common.h"
+#include "IO.h"
+
+namespace arrow
+{
+    class Table;
+}
+
+struct JsonlReadOptions
+{
+    std::vector<ColumnSelector> columns = {}; // columns to be read, in the given order; empty means all
+    int typeDeductionDepth = 100; // number of leading records that the columns and their types are deduced from
+    int threadCount = 1; // values other than 1 make the file parsed in chunks, yielding a chunked table; 0 uses all hardware threads
+    std::optional<Compression> compression; // of the file, detected from its first bytes if not given
+};
+
+struct JsonlWriteOptions
+{
+    int threadCount = 1; // threads formatting the records; 0 uses all hardware threads
+};
+
+// JSON Lines: each line is a JSON object describing a single row. Records are parsed with the SAX reader straight
+// into column builders.
+//
+// Columns are the keys found in the first `typeDeductionDepth` records, in the order of their first appearance.
+// Keys appearing only in later records are ignored, as are nested objects and arrays. Column types are deduced:
+// integers become Int64, numbers Double (JSON booleans are stored as 0 / 1), strings that all parse as timestamps
+// become Timestamp, other strings Text. Values that do not fit the column type, as well as absent keys and nulls,
+// are read as nulls.
+struct DFH_EXPORT FormatJSONL : TableFileHandlerWithOptions<JsonlReadOptions, JsonlWriteOptions>
+{
+    using TableFileHandler::read;
+    using TableFileHandler::write;
+
+    std::shared_ptr<arrow::Table> readString(std::string_view data, const JsonlReadOptions &options) const;
+    std::string writeToString(const arrow::Table &table, const JsonlWriteOptions &options) const;
+
+    virtual std::string fileSignature() const override;
+    virtual std::shared_ptr<arrow::Table> read(std::string_view filePath, const JsonlReadOptions &options) const override;
+    virtual void write(std::string_view filePath, const arrow::Table &table, const JsonlWriteOptions &options) const override;
+    virtual std::vector<std::string> fileExtensions() const override;
+    virtual bool readsCompressedFiles() const override;
+};
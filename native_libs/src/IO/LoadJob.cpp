@@ -0,0 +1,234 @@
+#include "LoadJob.h"
+#include "IO.h"
+#include "Core/Logger.h"
+
+#include <algorithm>
+#include <deque>
+#include <thread>
+#include <vector>
+
+#include <arrow/table.h>
+
+#include <boost/filesystem.hpp>
+
+namespace
+{
+    // Fixed set of threads running queued tasks in order. Loads are mostly bound by disk and by their own parallel
+    // parsing, so a few threads are enough to keep several of them in flight.
+    // When the pool is destroyed (at process exit or library unload), the jobs it runs are cancelled: queued ones
+    // immediately, running ones when their loaders next poll for cancellation. Only then the threads are joined.
+    class IOThreadPool
+    {
+        std::mutex mx;
+        std::condition_variable queueChanged;
+        std::deque<std::function<void()>> queue;
+        std::vector<std::weak_ptr<LoadJob>> jobs; // posted jobs, to be cancelled when stopping
+        std::vector<std::thread> threads;
+        bool stopping = false;
+
+        void work()
+        {
+            while(true)
+            {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock{mx};
+                    queueChanged.wait(lock, [&] { return stopping || !queue.empty(); });
+                    if(stopping)
+                        return;
+                    task = std::move(queue.front());
+                    queue.pop_front();
+                }
+                task();
+            }
+        }
+
+    public:
+        explicit IOThreadPool(int threadCount)
+        {
+            for(int i = 0; i < threadCount; i++)
+                threads.emplace_back([this] { work(); });
+        }
+        ~IOThreadPool()
+        {
+            std::vector<std::weak_ptr<LoadJob>> jobsToCancel;
+            {
+                std::unique_lock<std::mutex> lock{mx};
+                stopping = true;
+                jobsToCancel.swap(jobs);
+            }
+            for(auto &job : jobsToCancel)
+                if(auto liveJob = job.lock())
+                    liveJob->cancel();
+
+            queueChanged.notify_all();
+            for(auto &thread : threads)
+                thread.join();
+        }
+
+        void post(const std::shared_ptr<LoadJob> &job, std::function<void()> task)
+        {
+            {
+                std::unique_lock<std::mutex> lock{mx};
+                if(!stopping)
+                {
+                    jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [] (auto &&posted) { return posted.expired(); }), jobs.end());
+                    jobs.push_back(job);
+                    queue.push_back(std::move(task));
+                    lock.unlock();
+                    queueChanged.notify_one();
+                    return;
+                }
+            }
+
+            // Posted while the pool is going down: the task will never run, release the job's waiters instead.
+            job->cancel();
+        }
+
+        static IOThreadPool &instance()
+        {
+            static IOThreadPool pool{std::clamp<int>((int)std::thread::hardware_concurrency(), 2, 4)};
+            return pool;
+        }
+    };
+}
+
+void LoadProgress::throwIfCancelled() const
+{
+    if(cancelRequested)
+        throw LoadCancelled{};
+}
+
+LoadJob::LoadJob(Loader loader)
+    : loader(std::move(loader))
+{}
+
+std::shared_ptr<LoadJob> LoadJob::start(Loader loader)
+{
+    // constructor is private, so make_shared can't be used
+    std::shared_ptr<LoadJob> job{new LoadJob(std::move(loader))};
+    IOThreadPool::instance().post(job, [job] { job->run(); });
+    return job;
+}
+
+void LoadJob::run()
+{
+    {
+        std::unique_lock<std::mutex> lock{mx};
+        if(state_ != LoadJobState::Pending) // cancelled while queued
+            return;
+        state_ = LoadJobState::Running;
+    }
+
+    LOG("starting load job @{}", (void*)this);
+    try
+    {
+        progress_.throwIfCancelled();
+        auto loaded = loader(progress_);
+        progress_.throwIfCancelled(); // the loader might have completed without polling
+        finish(LoadJobState::Finished, std::move(loaded), nullptr);
+    }
+    catch(LoadCancelled &)
+    {
+        finish(LoadJobState::Cancelled, nullptr, std::current_exception());
+    }
+    catch(...)
+    {
+        finish(LoadJobState::Failed, nullptr, std::current_exception());
+    }
+}
+
+void LoadJob::finish(LoadJobState finalState, std::shared_ptr<arrow::Table> table, std::exception_ptr error)
+{
+    {
+        std::unique_lock<std::mutex> lock{mx};
+        state_ = finalState;
+        this->table = std::move(table);
+        this->error = std::move(error);
+        loader = nullptr; // releases whatever the loader captured
+    }
+    LOG("load job @{} is done with state {}", (void*)this, (int)finalState);
+    finished.notify_all();
+}
+
+bool LoadJob::isDone() const
+{
+    return state_ != LoadJobState::Pending && state_ != LoadJobState::Running;
+}
+
+LoadJobState LoadJob::state() const
+{
+    std::unique_lock<std::mutex> lock{mx};
+    return state_;
+}
+
+bool LoadJob::done() const
+{
+    std::unique_lock<std::mutex> lock{mx};
+    return isDone();
+}
+
+bool LoadJob::wait(std::chrono::milliseconds timeout) const
+{
+    std::unique_lock<std::mutex> lock{mx};
+    return finished.wait_for(lock, timeout, [&] { return isDone(); });
+}
+
+void LoadJob::wait() const
+{
+    std::unique_lock<std::mutex> lock{mx};
+    finished.wait(lock, [&] { return isDone(); });
+}
+
+void LoadJob::cancel()
+{
+    progress_.cancelRequested = true;
+
+    {
+        // the queued task of a pending job will see its state and return
+        std::unique_lock<std::mutex> lock{mx};
+        if(state_ != LoadJobState::Pending)
+            return;
+        state_ = LoadJobState::Cancelled;
+        error = std::make_exception_ptr(LoadCancelled{});
+        loader = nullptr;
+    }
+    finished.notify_all();
+}
+
+std::shared_ptr<arrow::Table> LoadJob::result() const
+{
+    wait();
+
+    std::unique_lock<std::mutex> lock{mx};
+    if(error)
+        std::rethrow_exception(error);
+    return table;
+}
+
+std::shared_ptr<LoadJob> readTableFromFileAsync(std::string filePath)
+{
+    return LoadJob::start([filePath = std::move(filePath)] (LoadProgress &progress)
+    {
+        if(detectCompression(filePath) == Compression::None)
+            progress.bytesTotal = (int64_t)boost::filesystem::file_size(filePath);
+
+        auto table = readTableFromFile(filePath, &progress);
+        progress.bytesRead = std::max(progress.bytesRead.load(), progress.bytesTotal.load());
+        progress.rowsParsed = table->num_rows();
+        return table;
+    });
+}
+
+std::shared_ptr<LoadJob> readTableFromCSVFileAsync(std::string filePath, CsvReadOptions options)
+{
+    return LoadJob::start([filePath = std::move(filePath), options = std::move(options)] (LoadProgress &progress) mutable
+    {
+        options.progress = &progress;
+        auto table = FormatCSV{}.read(filePath, options);
+        // parsed rows include the header and the ones rejected by predicate, the finished job reports the table length
+        progress.bytesRead = std::max(progress.bytesRead.load(), progress.bytesTotal.load());
+        progress.rowsParsed = table->num_rows();
+        return table;
+    });
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#include "Core/Common.h"
+#include "csv.h"
+
+namespace arrow
+{
+    class Table;
+}
+
+struct LoadCancelled : std::runtime_error
+{
+    LoadCancelled()
+        : std::runtime_error("table loading was cancelled")
+    {}
+};
+
+// Progress of loading a table, updated by the loading threads and readable from any thread.
+// Readers that support it report consumed input bytes and parsed rows, and poll for cancellation between blocks of work.
+struct DFH_EXPORT LoadProgress
+{
+    std::atomic<int64_t> bytesTotal{-1}; // -1 if unknown (e.g. for compressed files)
+    std::atomic<int64_t> bytesRead{0};
+    std::atomic<int64_t> rowsParsed{0};
+    std::atomic_bool cancelRequested{false};
+
+    void throwIfCancelled() const; // throws LoadCancelled
+};
+
+enum class LoadJobState : int8_t
+{
+    Pending, Running, Finished, Failed, Cancelled
+};
+
+// Table load running on the internal I/O thread pool. Jobs are shared: the pool keeps them alive until they are done,
+// so dropping the last outside reference does not stop the job (call `cancel` for that). Jobs still pending or running
+// when the library is unloaded are cancelled, and the unload waits for running loaders to notice that.
+class DFH_EXPORT LoadJob
+{
+public:
+    using Loader = std::function<std::shared_ptr<arrow::Table>(LoadProgress &)>;
+
+    static std::shared_ptr<LoadJob> start(Loader loader);
+
+    LoadJobState state() const;
+    bool done() const; // whether the job is finished, failed or cancelled
+    bool wait(std::chrono::milliseconds timeout) const; // returns whether the job is done
+    void wait() const;
+    void cancel(); // pending jobs are cancelled immediately, running ones when the loader next polls for cancellation
+    std::shared_ptr<arrow::Table> result() const; // waits for the job, rethrows its error (LoadCancelled if it was cancelled)
+
+    const LoadProgress &progress() const { return progress_; }
+
+private:
+    explicit LoadJob(Loader loader);
+    void run();
+    bool isDone() const; // expects the lock to be held
+    void finish(LoadJobState finalState, std::shared_ptr<arrow::Table> table, std::exception_ptr error);
+
+    Loader loader;
+    LoadProgress progress_;
+
+    mutable std::mutex mx;
+    mutable std::condition_variable finished;
+    LoadJobState state_ = LoadJobState::Pending;
+    std::shared_ptr<arrow::Table> table;
+    std::exception_ptr error;
+};
+
+// Start reading the file on the I/O thread pool, see `readTableFromFile` and `FormatCSV::read`.
+// CSV files report progress as they are parsed, other formats only once they are read.
+DFH_EXPORT std::shared_ptr<LoadJob> readTableFromFileAsync(std::string filePath);
+DFH_EXPORT std::shared_ptr<LoadJob> readTableFromCSVFileAsync(std::string filePath, CsvReadOptions options); // `options.progress` is overwritten
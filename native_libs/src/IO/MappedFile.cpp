@@ -0,0 +1,157 @@
+#include "MappedFile.h"
+#include "IO.h"
+
+#include "Core/Logger.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#include <filesystem>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(std::string_view filePath, AccessPattern expectedAccess /*= AccessPattern::Sequential*/)
+{
+#ifdef _WIN32
+    const auto widePath = std::filesystem::u8path(filePath).wstring();
+    const auto file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        CannotOpenToRead cannotRead{ filePath };
+        THROW_OBJ(cannotRead);
+    }
+
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize))
+    {
+        CloseHandle(file);
+        THROW("Failed to obtain size of file {}", filePath);
+    }
+
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+
+    // Mapping is padded with zeroes up to the page size, so unless the file fills the whole last page
+    // there is a place for the terminating null. Otherwise we fall back to reading the file.
+    const auto size = static_cast<size_t>(fileSize.QuadPart);
+    if(size == 0 || size % systemInfo.dwPageSize == 0)
+    {
+        CloseHandle(file);
+        useFallbackBuffer(filePath);
+        return;
+    }
+
+    const auto fileMapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    CloseHandle(file);
+    if(!fileMapping)
+    {
+        useFallbackBuffer(filePath);
+        return;
+    }
+
+    // the view keeps the mapping alive, so its handle can be closed right away
+    mapping = MapViewOfFile(fileMapping, FILE_MAP_COPY, 0, 0, 0);
+    CloseHandle(fileMapping);
+    if(!mapping)
+    {
+        useFallbackBuffer(filePath);
+        return;
+    }
+
+    // Windows has no counterpart of madvise hints for memory-mapped files that would be worth using here.
+    (void)expectedAccess;
+
+    mappingSize = size;
+    data_ = static_cast<char *>(mapping);
+    size_ = size;
+#else
+    const auto fd = ::open(std::string(filePath).c_str(), O_RDONLY);
+    if(fd == -1)
+    {
+        CannotOpenToRead cannotRead{ filePath };
+        THROW_OBJ(cannotRead);
+    }
+
+    struct stat fileInfo;
+    if(::fstat(fd, &fileInfo) == -1)
+    {
+        ::close(fd);
+        THROW("Failed to obtain size of file {}", filePath);
+    }
+
+    const auto size = static_cast<size_t>(fileInfo.st_size);
+    if(size == 0 || !S_ISREG(fileInfo.st_mode))
+    {
+        ::close(fd);
+        useFallbackBuffer(filePath);
+        return;
+    }
+
+    // First reserve the region for contents and the terminating null, then map the file over it.
+    // If the file fills its last page entirely, the null character lands on the reserved anonymous page.
+    const auto regionSize = size + 1;
+    const auto region = ::mmap(nullptr, regionSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(region == MAP_FAILED)
+    {
+        ::close(fd);
+        useFallbackBuffer(filePath);
+        return;
+    }
+
+    const auto mapped = ::mmap(region, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+    ::close(fd); // mapping keeps the file referenced
+    if(mapped == MAP_FAILED)
+    {
+        ::munmap(region, regionSize);
+        useFallbackBuffer(filePath);
+        return;
+    }
+
+    // The hint is just a hint -- failure is not a reason to give up.
+    const auto advice = [&]
+    {
+        switch(expectedAccess)
+        {
+        case AccessPattern::Sequential: return MADV_SEQUENTIAL;
+        case AccessPattern::Random:     return MADV_RANDOM;
+        default:                        return MADV_NORMAL;
+        }
+    }();
+    if(::madvise(mapped, size, advice) == -1)
+        LOG("madvise failed for {}", filePath);
+
+    mapping = region;
+    mappingSize = regionSize;
+    data_ = static_cast<char *>(mapped);
+    size_ = size;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    if(!mapping)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(mapping);
+#else
+    ::munmap(mapping, mappingSize);
+#endif
+}
+
+void MappedFile::useFallbackBuffer(std::string_view filePath)
+{
+    LOG("cannot map file {}, reading it into buffer", filePath);
+    fallbackBuffer = getFileContents(filePath);
+    data_ = fallbackBuffer.data();
+    size_ = fallbackBuffer.size();
+}
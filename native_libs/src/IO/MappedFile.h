@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "Core/Common.h"
+
+// Contents of a file, mapped into the process memory.
+//
+// The mapping is private (copy-on-write): contents can be modified in place (as the CSV parser does)
+// without affecting the file, and only the modified pages are copied. Like with std::string, the
+// contents are always followed by a writable null character.
+//
+// If the file cannot be mapped (e.g. it is empty), its contents are read into a regular buffer.
+class DFH_EXPORT MappedFile
+{
+public:
+    enum class AccessPattern
+    {
+        Normal, Sequential, Random
+    };
+
+    explicit MappedFile(std::string_view filePath, AccessPattern expectedAccess = AccessPattern::Sequential);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    char *data() const { return data_; }
+    size_t size() const { return size_; }
+    std::string_view view() const { return { data_, size_ }; }
+    bool isMapped() const { return mapping != nullptr; }
+
+private:
+    char *data_{};
+    size_t size_{};
+
+    void *mapping{}; // start of the mapped memory region (nullptr if not mapped)
+    size_t mappingSize{};
+    std::string fallbackBuffer;
+
+    void useFallbackBuffer(std::string_view filePath);
+};
@@ -0,0 +1,423 @@
+#include "Parquet.h"
+#include "IO.h"
+
+#include "Core/ArrowUtilities.h"
+#include "Core/Common.h"
+#include "Core/Error.h"
+#include "Core/Parallel.h"
+#include "LQuery/AST.h"
+#include "Processing.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+
+#include <arrow/io/file.h>
+#include <arrow/table.h>
+
+#ifdef DISABLE_PARQUET
+
+#pragma message("Note: DataframeHelper is being compiled without Parquet support.")
+
+namespace
+{
+    std::vector<int> selectRowGroups(std::string_view filePath, const ParquetReadOptions &options)
+    {
+        THROW("The library was compiled without Parquet support!");
+    }
+    std::shared_ptr<arrow::Table> readParquet(std::string_view filePath, const ParquetReadOptions &options)
+    {
+        THROW("The library was compiled without Parquet support!");
+    }
+    void writeParquet(std::string_view filePath, const arrow::Table &table, const ParquetWriteOptions &options)
+    {
+        THROW("The library was compiled without Parquet support!");
+    }
+}
+
+#else // DISABLE_PARQUET
+
+#include <parquet/arrow/reader.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/file_reader.h>
+#include <parquet/metadata.h>
+#include <parquet/statistics.h>
+
+namespace
+{
+    // Memory-mapped file with its parsed metadata. Each thread opens its own reader on top of it,
+    // as there is no need to parse the metadata again and the mapping can be read concurrently.
+    struct ParquetFile
+    {
+        std::shared_ptr<arrow::io::MemoryMappedFile> file;
+        std::shared_ptr<parquet::FileMetaData> metadata;
+        std::shared_ptr<arrow::Schema> schema; // as stored in the file (i.e. before adjusting timestamp units)
+
+        explicit ParquetFile(std::string_view filePath)
+        {
+            checkStatus(arrow::io::MemoryMappedFile::Open((std::string)filePath, arrow::io::FileMode::READ, &file));
+            const auto reader = openReader();
+            metadata = reader->parquet_reader()->metadata();
+            checkStatus(reader->GetSchema(&schema));
+        }
+
+        std::unique_ptr<parquet::arrow::FileReader> openReader() const
+        {
+            auto fileReader = parquet::ParquetFileReader::Open(file, parquet::default_reader_properties(), metadata);
+            return std::make_unique<parquet::arrow::FileReader>(arrow::default_memory_pool(), std::move(fileReader));
+        }
+
+        // Index of the Parquet column storing the given schema field.
+        int leafColumnIndex(int fieldIndex) const
+        {
+            const auto &name = schema->field(fieldIndex)->name();
+            const auto index = metadata->schema()->ColumnIndex(name);
+            if(index < 0)
+                THROW("Column `{}` is not supported: only flat Parquet schemas can be read", name);
+            return index;
+        }
+    };
+
+    int64_t nanosecondsPerUnit(arrow::TimeUnit::type unit)
+    {
+        switch(unit)
+        {
+        case arrow::TimeUnit::SECOND: return 1'000'000'000;
+        case arrow::TimeUnit::MILLI:  return 1'000'000;
+        case arrow::TimeUnit::MICRO:  return 1'000;
+        default:                      return 1;
+        }
+    }
+
+    TypePtr adjustedType(const TypePtr &type)
+    {
+        if(type->id() == arrow::Type::TIMESTAMP)
+            return getTypeSingleton<arrow::Type::TIMESTAMP>();
+        return type;
+    }
+
+    // The library uses nanosecond timestamps, while Parquet files usually store coarser ones.
+    std::shared_ptr<arrow::Column> withNanosecondTimestamps(std::shared_ptr<arrow::Column> column)
+    {
+        if(column->type()->id() != arrow::Type::TIMESTAMP)
+            return column;
+
+        const auto multiplier = nanosecondsPerUnit(static_cast<const arrow::TimestampType &>(*column->type()).unit());
+        if(multiplier == 1)
+            return column;
+
+        const auto type = getTypeSingleton<arrow::Type::TIMESTAMP>();
+        const auto chunks = transformToVector(column->data()->chunks(), [&] (const std::shared_ptr<arrow::Array> &chunk)
+        {
+            // values keep the chunk offset, so the null bitmap can be shared
+            const auto offset = chunk->offset();
+            const auto sourceValues = static_cast<const arrow::TimestampArray &>(*chunk).raw_values();
+            auto [buffer, values] = allocateBuffer<int64_t>(offset + chunk->length());
+            for(int64_t i = 0; i < chunk->length(); i++)
+                values[offset + i] = sourceValues[i] * multiplier;
+
+            const auto &data = *chunk->data();
+            return arrow::MakeArray(arrow::ArrayData::Make(type, chunk->length(), { data.buffers[0], buffer }, chunk->null_count(), offset));
+        });
+        return std::make_shared<arrow::Column>(arrow::field(column->name(), type, column->field()->nullable()), chunks);
+    }
+
+    using StatisticsValue = variant<int64_t, double, std::string>;
+
+    struct ColumnStatistics
+    {
+        StatisticsValue min, max;
+    };
+
+    template<typename Statistics, typename F>
+    ColumnStatistics typedStatistics(const parquet::RowGroupStatistics &statistics, F &&convert)
+    {
+        const auto &typed = static_cast<const Statistics &>(statistics);
+        return { convert(typed.min()), convert(typed.max()) };
+    }
+
+    // Returns min and max of the column values in row group, converted to how the library represents them.
+    // Statistics that are absent or not known to be valid for the column type yield nullopt.
+    std::optional<ColumnStatistics> columnStatistics(const parquet::RowGroupMetaData &rowGroup, int leafColumnIndex, const arrow::DataType &type)
+    {
+        const auto chunk = rowGroup.ColumnChunk(leafColumnIndex);
+        const auto statistics = chunk->is_stats_set() ? chunk->statistics() : nullptr;
+        if(!statistics || !statistics->HasMinMax())
+            return std::nullopt;
+
+        const auto timestampMultiplier = type.id() == arrow::Type::TIMESTAMP
+            ? nanosecondsPerUnit(static_cast<const arrow::TimestampType &>(type).unit())
+            : 1;
+        const auto asInt64 = [&] (auto value) { return StatisticsValue{ (int64_t)value * timestampMultiplier }; };
+        const auto asDouble = [] (auto value) { return StatisticsValue{ (double)value }; };
+
+        switch(statistics->physical_type())
+        {
+        case parquet::Type::INT32:
+            if(arrow::is_integer(type.id()))
+                return typedStatistics<parquet::Int32Statistics>(*statistics, asInt64);
+            break;
+        case parquet::Type::INT64:
+            if(arrow::is_integer(type.id()) || type.id() == arrow::Type::TIMESTAMP)
+                return typedStatistics<parquet::Int64Statistics>(*statistics, asInt64);
+            break;
+        case parquet::Type::FLOAT:
+            return typedStatistics<parquet::FloatStatistics>(*statistics, asDouble);
+        case parquet::Type::DOUBLE:
+            return typedStatistics<parquet::DoubleStatistics>(*statistics, asDouble);
+        case parquet::Type::BYTE_ARRAY:
+            if(type.id() == arrow::Type::STRING)
+                return typedStatistics<parquet::ByteArrayStatistics>(*statistics, [] (const parquet::ByteArray &value)
+                {
+                    return StatisticsValue{ std::string(reinterpret_cast<const char *>(value.ptr), value.len) };
+                });
+            break;
+        default:
+            break;
+        }
+        return std::nullopt;
+    }
+
+    // Three-way comparison, nullopt if values are not comparable (strings with numbers).
+    std::optional<int> compareValues(const StatisticsValue &lhs, const StatisticsValue &rhs)
+    {
+        return visit([] (auto &&l, auto &&r) -> std::optional<int>
+        {
+            using L = std::decay_t<decltype(l)>;
+            using R = std::decay_t<decltype(r)>;
+            if constexpr(std::is_same_v<L, std::string> != std::is_same_v<R, std::string>)
+                return std::nullopt;
+            else
+                return l < r ? -1 : (r < l ? 1 : 0);
+        }, lhs, rhs);
+    }
+
+    std::optional<StatisticsValue> literalValue(const ast::Value &value)
+    {
+        return visit(overloaded{
+            [] (const ast::Literal<int64_t> &l)     -> std::optional<StatisticsValue> { return l.literal; },
+            [] (const ast::Literal<double> &l)      -> std::optional<StatisticsValue> { return l.literal; },
+            [] (const ast::Literal<std::string> &l) -> std::optional<StatisticsValue> { return l.literal; },
+            [] (const ast::Literal<Timestamp> &l)   -> std::optional<StatisticsValue> { return l.literal.toStorage(); },
+            [] (auto &&)                            -> std::optional<StatisticsValue> { return std::nullopt; }
+            }, (const ast::ValueBase &)value);
+    }
+
+    using StatisticsLookup = std::function<std::optional<ColumnStatistics>(ColumnReferenceId)>;
+
+    // Whether `column <operator> literal` (or `literal <operator> column`) may hold for some values within statistics range.
+    bool comparisonMayBeSatisfied(const ast::PredicateFromValueOperation &comparison, const StatisticsLookup &statistics)
+    {
+        if(comparison.operands.size() != 2)
+            return true;
+
+        auto what = comparison.what;
+        auto column = get_if<ast::ColumnReference>(&(const ast::ValueBase &)comparison.operands[0]);
+        auto literal = literalValue(comparison.operands[1]);
+        if(!column)
+        {
+            // literal on the left side: mirror the comparison
+            column = get_if<ast::ColumnReference>(&(const ast::ValueBase &)comparison.operands[1]);
+            literal = literalValue(comparison.operands[0]);
+            if(what == ast::PredicateFromValueOperator::Greater)
+                what = ast::PredicateFromValueOperator::Lesser;
+            else if(what == ast::PredicateFromValueOperator::Lesser)
+                what = ast::PredicateFromValueOperator::Greater;
+        }
+        if(!column || !literal)
+            return true;
+
+        const auto range = statistics(column->columnRefId);
+        if(!range)
+            return true;
+
+        switch(what)
+        {
+        case ast::PredicateFromValueOperator::Greater:
+            return compareValues(range->max, *literal).value_or(1) > 0;
+        case ast::PredicateFromValueOperator::Lesser:
+            return compareValues(range->min, *literal).value_or(-1) < 0;
+        case ast::PredicateFromValueOperator::Equal:
+            return compareValues(range->min, *literal).value_or(0) <= 0
+                && compareValues(range->max, *literal).value_or(0) >= 0;
+        default:
+            return true;
+        }
+    }
+
+    bool mayBeSatisfied(const ast::Predicate &predicate, const StatisticsLookup &statistics)
+    {
+        return visit(overloaded{
+            [&] (const ast::PredicateOperation &operation)
+            {
+                const auto operandMayBeSatisfied = [&] (const ast::Predicate &operand) { return mayBeSatisfied(operand, statistics); };
+                switch(operation.what)
+                {
+                case ast::PredicateOperator::And:
+                    return std::all_of(operation.operands.begin(), operation.operands.end(), operandMayBeSatisfied);
+                case ast::PredicateOperator::Or:
+                    return std::any_of(operation.operands.begin(), operation.operands.end(), operandMayBeSatisfied);
+                default:
+                    return true; // statistics don't tell whether all values satisfy the negated predicate
+                }
+            },
+            [&] (const ast::PredicateFromValueOperation &comparison)
+            {
+                return comparisonMayBeSatisfied(comparison, statistics);
+            }
+            }, (const ast::PredicateBase &)predicate);
+    }
+
+    std::pair<ColumnMapping, ast::Predicate> parsePredicate(const arrow::Schema &schema, const char *predicateJson)
+    {
+        // Parser only needs to look up columns by names, there is no need to read their values.
+        const auto columns = transformToVector(schema.fields(), [] (const std::shared_ptr<arrow::Field> &field)
+        {
+            return std::make_shared<arrow::Column>(field, makeNullsArray(adjustedType(field->type()), 0));
+        });
+        const auto table = arrow::Table::Make(arrow::schema(schema.fields()), columns);
+        return ast::parsePredicate(*table, predicateJson);
+    }
+
+    std::vector<int> selectRowGroups(const ParquetFile &file, const ParquetReadOptions &options)
+    {
+        const auto rowGroupCount = file.metadata->num_row_groups();
+        auto rowGroups = options.rowGroups.empty() ? iotaVector<int>(rowGroupCount) : options.rowGroups;
+        for(auto rowGroup : rowGroups)
+            if(rowGroup < 0 || rowGroup >= rowGroupCount)
+                THROW("Cannot select row group #{}: there are {} row groups", rowGroup, rowGroupCount);
+
+        if(options.predicate.empty())
+            return rowGroups;
+
+        const auto [mapping, predicate] = parsePredicate(*file.schema, options.predicate.c_str());
+        const auto end = std::remove_if(rowGroups.begin(), rowGroups.end(), [&, &mapping = mapping, &predicate = predicate] (int rowGroupIndex)
+        {
+            const auto rowGroup = file.metadata->RowGroup(rowGroupIndex);
+            return !mayBeSatisfied(predicate, [&] (ColumnReferenceId reference)
+            {
+                const auto fieldIndex = mapping.at(reference);
+                return columnStatistics(*rowGroup, file.leafColumnIndex(fieldIndex), *file.schema->field(fieldIndex)->type());
+            });
+        });
+        rowGroups.erase(end, rowGroups.end());
+        return rowGroups;
+    }
+
+    std::vector<int> selectRowGroups(std::string_view filePath, const ParquetReadOptions &options)
+    {
+        return selectRowGroups(ParquetFile{filePath}, options);
+    }
+
+    std::shared_ptr<arrow::Table> readParquet(std::string_view filePath, const ParquetReadOptions &options)
+    {
+        const ParquetFile file{filePath};
+        const auto names = transformToVector(file.schema->fields(), [] (auto &&field) { return field->name(); });
+        const auto selectedColumns = selectColumnIndices(options.columns, names);
+
+        // Columns used only by the predicate are decoded too, but are dropped after filtering.
+        auto decodedColumns = selectedColumns;
+        if(options.predicate.size())
+        {
+            const auto mapping = parsePredicate(*file.schema, options.predicate.c_str()).first;
+            for(auto &&[reference, fieldIndex] : mapping)
+                if(std::find(decodedColumns.begin(), decodedColumns.end(), fieldIndex) == decodedColumns.end())
+                    decodedColumns.push_back(fieldIndex);
+        }
+        const auto leafColumns = transformToVector(decodedColumns, [&] (int fieldIndex) { return file.leafColumnIndex(fieldIndex); });
+
+        const auto rowGroups = selectRowGroups(file, options);
+        std::vector<std::shared_ptr<arrow::Table>> tables(rowGroups.size());
+        parallelFor(rowGroups.size(), options.threadCount, [&] (int64_t i)
+        {
+            std::shared_ptr<arrow::Table> rowGroup;
+            checkStatus(file.openReader()->ReadRowGroup(rowGroups[i], leafColumns, &rowGroup));
+
+            auto columns = transformToVector(getColumns(*rowGroup), withNanosecondTimestamps);
+            rowGroup = tableFromColumns(columns);
+            if(options.predicate.size())
+                rowGroup = filter(rowGroup, options.predicate.c_str());
+
+            // decoded columns come in the file order, selection may use a different one
+            columns = transformToVector(selectedColumns, [&] (int fieldIndex)
+            {
+                return rowGroup->column(rowGroup->schema()->GetFieldIndex(names[fieldIndex]));
+            });
+            tables[i] = tableFromColumns(columns);
+        });
+
+        if(tables.empty())
+        {
+            // all row groups were skipped, the result still needs the columns
+            const auto columns = transformToVector(selectedColumns, [&] (int fieldIndex)
+            {
+                const auto &field = *file.schema->field(fieldIndex);
+                const auto type = adjustedType(field.type());
+                return std::make_shared<arrow::Column>(arrow::field(field.name(), type, field.nullable()), makeNullsArray(type, 0));
+            });
+            return tableFromColumns(columns);
+        }
+
+        return concatenateTables(tables);
+    }
+
+    parquet::Compression::type compressionCodec(ParquetCompression compression)
+    {
+        switch(compression)
+        {
+        case ParquetCompression::None:   return parquet::Compression::UNCOMPRESSED;
+        case ParquetCompression::Snappy: return parquet::Compression::SNAPPY;
+        case ParquetCompression::Gzip:   return parquet::Compression::GZIP;
+        case ParquetCompression::Zstd:   return parquet::Compression::ZSTD;
+        default:                         THROW("unknown Parquet compression {}", (int)compression);
+        }
+    }
+
+    void writeParquet(std::string_view filePath, const arrow::Table &table, const ParquetWriteOptions &options)
+    {
+        if(options.rowGroupSize <= 0)
+            THROW("row group size must be positive, got {}", options.rowGroupSize);
+
+        std::shared_ptr<arrow::io::FileOutputStream> out;
+        checkStatus(arrow::io::FileOutputStream::Open((std::string)filePath, &out));
+
+        // Dictionary-encoded columns are stored as plain ones, Parquet applies its own dictionary encoding anyway.
+        const auto columns = transformToVector(getColumns(table), [] (std::shared_ptr<arrow::Column> column)
+        {
+            return column->type()->id() == arrow::Type::DICTIONARY ? decodeDictionary(column) : column;
+        });
+        const auto plainTable = tableFromColumns(columns);
+
+        const auto properties = parquet::WriterProperties::Builder().compression(compressionCodec(options.compression))->build();
+        const auto arrowProperties = parquet::ArrowWriterProperties::Builder().coerce_timestamps(arrow::TimeUnit::MICRO)->build();
+        checkStatus(parquet::arrow::WriteTable(*plainTable, arrow::default_memory_pool(), out, options.rowGroupSize, properties, arrowProperties));
+        checkStatus(out->Close());
+    }
+}
+
+#endif // DISABLE_PARQUET
+
+std::vector<int> FormatParquet::rowGroupsToRead(std::string_view filePath, const ParquetReadOptions &options) const
+{
+    return selectRowGroups(filePath, options);
+}
+
+std::string FormatParquet::fileSignature() const
+{
+    return "PAR1";
+}
+
+std::shared_ptr<arrow::Table> FormatParquet::read(std::string_view filePath, const ParquetReadOptions &options) const
+{
+    return readParquet(filePath, options);
+}
+
+void FormatParquet::write(std::string_view filePath, const arrow::Table &table, const ParquetWriteOptions &options) const
+{
+    writeParquet(filePath, table, options);
+}
+
+std::vector<std::string> FormatParquet::fileExtensions() const
+{
+    return { "parquet" };
+}
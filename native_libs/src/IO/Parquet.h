@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Core/Common.h"
+#include "IO.h"
+
+namespace arrow
+{
+    class Table;
+}
+
+enum class ParquetCompression : int8_t
+{
+    None, Snappy, Gzip, Zstd
+};
+
+struct ParquetReadOptions
+{
+    std::vector<ColumnSelector> columns = {}; // columns to be read, in the given order; empty means all
+    std::vector<int> rowGroups = {}; // indices of row groups to be read; empty means all
+    std::string predicate; // LQuery predicate JSON, only rows satisfying it are read; empty means all
+    int threadCount = 0; // threads decoding row groups; 0 uses all hardware threads
+};
+
+struct ParquetWriteOptions
+{
+    int64_t rowGroupSize = 1 << 20; // maximum row count of a row group
+    ParquetCompression compression = ParquetCompression::Snappy;
+};
+
+// Each row group read becomes a separate chunk of the table columns. Timestamps are read as nanosecond ones
+// (whatever unit the file uses) and are written with microsecond precision.
+// Only flat schemas (without nested columns) are supported.
+struct DFH_EXPORT FormatParquet : TableFileHandlerWithOptions<ParquetReadOptions, ParquetWriteOptions>
+{
+    using TableFileHandler::read;
+    using TableFileHandler::write;
+
+    // Returns indices of the row groups that will be decoded for the given options. Row groups whose column
+    // statistics show that no row can satisfy the predicate are skipped (predicate parts other than comparisons
+    // of a column with a literal, joined by `and` / `or`, are assumed to be satisfiable).
+    std::vector<int> rowGroupsToRead(std::string_view filePath, const ParquetReadOptions &options) const;
+
+    virtual std::string fileSignature() const override;
+    virtual std::shared_ptr<arrow::Table> read(std::string_view filePath, const ParquetReadOptions &options) const override;
+    virtual void write(std::string_view filePath, const arrow::Table &table, const ParquetWriteOptions &options) const override;
+    virtual std::vector<std::string> fileExtensions() const override;
+};
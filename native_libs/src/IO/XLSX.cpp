@@ -8,7 +8,9 @@
 #include <arrow/builder.h>
 #include <arrow/table.h>
 
+#include <algorithm>
 #include <fstream>
+#include <string_view>
 
 #ifdef DISABLE_XLSX
 
@@ -16,7 +18,7 @@
 
 namespace
 {
-    std::shared_ptr<arrow::Table> readXlsxInput(std::istream &input, HeaderPolicy header, std::vector<ColumnType> columnTypes)
+    std::shared_ptr<arrow::Table> readXlsxInput(std::istream &input, const XlsxReadOptions &options)
     {
         THROW("The library was compiled without XLSX support!");
     }
@@ -30,12 +32,17 @@ namespace
 
 #include <xlnt/xlnt.hpp>
 
+#ifndef DISABLE_GZIP
+#include <zlib.h>
+#endif
+
 namespace
 {
     using namespace std::literals;
 
     struct ColumnBuilderBase
     {
+        virtual ~ColumnBuilderBase() = default;
         virtual void addFromCell(const xlnt::cell &field) = 0;
         virtual void addMissing() = 0;
         virtual void reserve(int64_t count) = 0;
@@ -97,66 +104,320 @@ namespace
         }
     };
 
-    std::shared_ptr<arrow::Table> readXlsxInput(std::istream &input, HeaderPolicy header, std::vector<ColumnType> columnTypes)
+    std::unique_ptr<ColumnBuilderBase> makeColumnBuilder(const ColumnType &columnType)
+    {
+        return visitType(*columnType.type, [&](auto id) -> std::unique_ptr<ColumnBuilderBase>
+        {
+            return std::make_unique<ColumnBuilder<id.value>>(columnType.nullable);
+        });
+    }
+
+    // Cells of a single sheet column. Rows that have no cell in the column are filled with missing values.
+    struct StreamedColumn
+    {
+        std::unique_ptr<ColumnBuilderBase> builder;
+        int64_t rowCount = 0;
+
+        void fillMissingUpTo(int64_t row)
+        {
+            for(; rowCount < row; rowCount++)
+                builder->addMissing();
+        }
+    };
+
+    template<typename T>
+    T readLittleEndian(const char *data)
+    {
+        T ret = 0;
+        for(size_t i = 0; i < sizeof(T); i++)
+            ret |= T((unsigned char)data[i]) << (8 * i);
+        return ret;
+    }
+
+    std::string readAt(std::istream &input, int64_t offset, int64_t length)
+    {
+        std::string ret(length, '\0');
+        input.seekg(offset);
+        input.read(ret.data(), length);
+        if(input.gcount() != length)
+            THROW("unexpected end of zip archive");
+        return ret;
+    }
+
+    std::optional<std::string> inflateZipEntry(const std::string &compressed, size_t uncompressedSize)
+    {
+#ifndef DISABLE_GZIP
+        // negative window bits select raw deflate data, without zlib header, as stored in zip archives
+        z_stream stream{};
+        if(inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+            return std::nullopt;
+
+        std::string ret(uncompressedSize, '\0');
+        stream.next_in = (Bytef *)compressed.data();
+        stream.avail_in = (uInt)compressed.size();
+        stream.next_out = (Bytef *)ret.data();
+        stream.avail_out = (uInt)ret.size();
+        const auto status = inflate(&stream, Z_FINISH);
+        inflateEnd(&stream);
+        if(status != Z_STREAM_END)
+            return std::nullopt;
+
+        ret.resize(stream.total_out);
+        return ret;
+#else
+        return std::nullopt;
+#endif
+    }
+
+    // Contents of a single zip archive entry, nullopt if there is no such entry or it cannot be decompressed.
+    // ZIP64 records are not supported: fields set to their all-ones sentinels make it return nullopt as well.
+    std::optional<std::string> readZipEntry(std::istream &input, std::string_view name)
+    {
+        constexpr uint32_t zip64Sentinel = 0xFFFFFFFF;
+        input.seekg(0, std::ios::end);
+        const auto size = (int64_t)input.tellg();
+
+        // end of central directory record takes 22 bytes and may be followed by a comment of up to 64 KiB
+        const auto tailLength = std::min<int64_t>(size, 22 + 0xFFFF);
+        const auto tail = readAt(input, size - tailLength, tailLength);
+        const auto endRecord = tail.rfind("PK\x05\x06"sv);
+        if(endRecord == std::string::npos || endRecord + 22 > tail.size())
+            return std::nullopt;
+
+        const auto entryCount = readLittleEndian<uint16_t>(&tail[endRecord + 10]);
+        const auto directorySize = readLittleEndian<uint32_t>(&tail[endRecord + 12]);
+        const auto directoryOffset = readLittleEndian<uint32_t>(&tail[endRecord + 16]);
+        if(entryCount == 0xFFFF || directorySize == zip64Sentinel || directoryOffset == zip64Sentinel
+            || (int64_t)directoryOffset + directorySize > size)
+            return std::nullopt;
+        const auto directory = readAt(input, directoryOffset, directorySize);
+
+        size_t position = 0;
+        for(int i = 0; i < entryCount && position + 46 <= directory.size(); i++)
+        {
+            const auto header = &directory[position];
+            if(readLittleEndian<uint32_t>(header) != 0x02014b50)
+                return std::nullopt;
+
+            const auto method = readLittleEndian<uint16_t>(header + 10);
+            const auto compressedSize = readLittleEndian<uint32_t>(header + 20);
+            const auto uncompressedSize = readLittleEndian<uint32_t>(header + 24);
+            const auto nameLength = readLittleEndian<uint16_t>(header + 28);
+            const auto extraLength = readLittleEndian<uint16_t>(header + 30);
+            const auto commentLength = readLittleEndian<uint16_t>(header + 32);
+            const auto localHeaderOffset = readLittleEndian<uint32_t>(header + 42);
+            const auto entryName = std::string_view{directory}.substr(position + 46, nameLength);
+            position += 46 + nameLength + extraLength + commentLength;
+            if(entryName != name)
+                continue;
+            if(compressedSize == zip64Sentinel || uncompressedSize == zip64Sentinel || localHeaderOffset == zip64Sentinel
+                || (int64_t)localHeaderOffset + 30 + compressedSize > size)
+                return std::nullopt;
+
+            const auto localHeader = readAt(input, localHeaderOffset, 30);
+            const auto dataOffset = (int64_t)localHeaderOffset + 30 + readLittleEndian<uint16_t>(&localHeader[26]) + readLittleEndian<uint16_t>(&localHeader[28]);
+            auto data = readAt(input, dataOffset, compressedSize);
+            if(method == 0) // stored
+                return data;
+            if(method == 8) // deflated
+                return inflateZipEntry(data, uncompressedSize);
+            return std::nullopt;
+        }
+        return std::nullopt;
+    }
+
+    // Value of the attribute within the XML element starting at `elementStart`, nullopt if the element has no such attribute.
+    std::optional<std::string> xmlAttribute(std::string_view xml, size_t elementStart, std::string_view attribute)
+    {
+        const auto elementEnd = xml.find('>', elementStart);
+        const auto element = xml.substr(elementStart, elementEnd - elementStart);
+        const auto pattern = " "s + std::string(attribute) + "=\"";
+        const auto valueStart = element.find(pattern);
+        if(valueStart == std::string_view::npos)
+            return std::nullopt;
+
+        const auto value = element.substr(valueStart + pattern.size(), element.find('"', valueStart + pattern.size()) - valueStart - pattern.size());
+        std::string ret;
+        for(size_t i = 0; i < value.size(); i++)
+        {
+            if(value[i] != '&')
+            {
+                ret += value[i];
+                continue;
+            }
+
+            const auto entityEnd = value.find(';', i);
+            const auto entity = value.substr(i, entityEnd - i + 1);
+            if(entity == "&amp;") ret += '&';
+            else if(entity == "&lt;") ret += '<';
+            else if(entity == "&gt;") ret += '>';
+            else if(entity == "&quot;") ret += '"';
+            else if(entity == "&apos;") ret += '\'';
+            else return std::nullopt; // character references are not worth supporting here
+            i = entityEnd;
+        }
+        return ret;
+    }
+
+    // Title of the sheet that was active when the workbook got saved, read from the `activeTab` attribute of the
+    // workbook part (the first sheet if it is not there). xlnt's streaming reader does not expose it, so the part is
+    // read from the archive directly. Returns nullopt if the title cannot be found out, e.g. for ZIP64 archives
+    // (their sizes and offsets don't fit the fields read here) or unexpected XML.
+    std::optional<std::string> activeSheetTitle(std::istream &input)
     {
         try
         {
-            xlnt::workbook wb;
-            wb.load(input);
-            const auto sheet = wb.active_sheet();
+            const auto workbookXml = readZipEntry(input, "xl/workbook.xml");
+            if(!workbookXml)
+                return std::nullopt;
 
-            // We keep the object under unique_ptr, so there will be
-            // no leak if exception is thrown before the end of function
-            const auto rowCount = (int64_t)sheet.highest_row();
-            const auto columnCount = (int32_t)sheet.highest_column().index;
+            int activeTab = 0;
+            if(const auto view = workbookXml->find("<workbookView"); view != std::string::npos)
+                if(const auto attribute = xmlAttribute(*workbookXml, view, "activeTab"))
+                    activeTab = std::stoi(*attribute);
 
-            // If there is no type info for column, default to non-nullable Text (it always works)
-            if((int)columnTypes.size() < columnCount)
+            size_t sheet = 0;
+            for(int i = 0; i <= activeTab; i++)
             {
-                const ColumnType nonNullableText{ std::make_shared<arrow::StringType>(), false, false };
-                columnTypes.resize(columnCount, nonNullableText);
+                sheet = workbookXml->find("<sheet ", i ? sheet + 1 : 0);
+                if(sheet == std::string::npos)
+                    return std::nullopt;
             }
-            const auto names = decideColumnNames(columnCount, header, [&](int column)
+            return xmlAttribute(*workbookXml, sheet, "name");
+        }
+        catch(std::exception &)
+        {
+            // the workbook is then loaded by xlnt, which will tell if it is really broken
+            return std::nullopt;
+        }
+    }
+
+    // Cells are streamed from the sheet XML straight into column builders, so the sheet is never held in memory.
+    // Columns are selected once the header row was read or, without header row, upfront if all are given by index.
+    // In other cases all columns are collected and the ones not selected are dropped at the end.
+    // If the active sheet cannot be told for streaming, the whole workbook is loaded and cells of its active sheet
+    // are fed the same way.
+    std::shared_ptr<arrow::Table> readXlsxInput(std::istream &input, const XlsxReadOptions &options)
+    {
+        try
+        {
+            const auto activeTitle = activeSheetTitle(input);
+            input.clear();
+            input.seekg(0);
+
+            // If there is no type info for column, default to non-nullable Text (it always works)
+            const ColumnType nonNullableText{ std::make_shared<arrow::StringType>(), false, false };
+            const auto columnType = [&](int column)
             {
-                return sheet.cell(column + 1, 0 + 1).to_string();
-            });
-            const bool useFirstRowAsHeaders = holds_alternative<TakeFirstRowAsHeaders>(header);
+                return column < (int)options.columnTypes.size() ? options.columnTypes[column] : nonNullableText;
+            };
 
-            // setup column builders
-            std::vector<std::unique_ptr<ColumnBuilderBase>> columnBuilders;
-            for(auto columnType : columnTypes)
+            const bool useFirstRowAsHeaders = holds_alternative<TakeFirstRowAsHeaders>(options.header);
+            std::vector<std::string> headerCells;
+            const auto namesForColumnCount = [&](int columnCount)
             {
-                auto ptr = visitType(*columnType.type, [&](auto id) -> std::unique_ptr<ColumnBuilderBase>
+                return decideColumnNames(columnCount, options.header, [&](int column)
                 {
-                    return std::make_unique<ColumnBuilder<id.value>>(columnType.nullable);
+                    return column < (int)headerCells.size() ? headerCells[column] : ""s;
                 });
-                ptr->reserve(rowCount);
-                columnBuilders.push_back(std::move(ptr));
-            }
-            for(auto i = columnBuilders.size(); i < columnCount; i++)
+            };
+
+            // nullopt until known which columns are wanted, all of them are collected until then. Without header row,
+            // names are known only when all cells were read (they depend on the column count), so name selectors are
+            // resolved at the end.
+            std::optional<std::vector<int>> wantedColumns;
+            if(options.columns.empty())
+                wantedColumns = std::vector<int>{};
+            else if(!useFirstRowAsHeaders && std::all_of(options.columns.begin(), options.columns.end(), [](auto &&selector) { return holds_alternative<int>(selector); }))
+                wantedColumns = transformToVector(options.columns, [](auto &&selector) { return get<int>(selector); });
+            const auto isWanted = [&](int column)
             {
-                columnBuilders.push_back(std::make_unique<ColumnBuilder<arrow::Type::STRING>>(false));
-            }
+                return !wantedColumns || wantedColumns->empty()
+                    || std::find(wantedColumns->begin(), wantedColumns->end(), column) != wantedColumns->end();
+            };
 
-            for(int column = 0; column < columnCount; column++)
+            std::vector<std::optional<StreamedColumn>> columns; // indexed by sheet column
+            int64_t rowCount = 0; // data rows, i.e. not counting the header
+            // returns false when no more cells are needed
+            const auto consumeCell = [&](const xlnt::cell &cell)
             {
-                for(int row = useFirstRowAsHeaders; row < rowCount; row++)
+                const auto column = (int)cell.column().index - 1;
+                const auto sheetRow = (int64_t)cell.row() - 1;
+                if(useFirstRowAsHeaders && sheetRow == 0)
                 {
-                    xlnt::cell_reference cellPos(column + 1, row + 1);
-                    if(sheet.has_cell(cellPos))
-                        columnBuilders[column]->addFromCell(sheet.cell(cellPos));
-                    else
-                        columnBuilders[column]->addMissing();
+                    if(column >= (int)headerCells.size())
+                        headerCells.resize(column + 1);
+                    headerCells[column] = cell.to_string();
+                    return true;
                 }
-            }
 
-            std::vector<std::shared_ptr<arrow::Array>> arrays;
-            for(auto &builder : columnBuilders)
-                arrays.push_back(builder->finish());
+                // cells come row by row, so there's nothing more to read
+                const auto row = sheetRow - useFirstRowAsHeaders;
+                if(options.rowLimit && row >= *options.rowLimit)
+                    return false;
+
+                // row count must not depend on which columns are selected
+                rowCount = std::max(rowCount, row + 1);
+
+                if(!wantedColumns && useFirstRowAsHeaders)
+                    wantedColumns = selectColumnIndices(options.columns, namesForColumnCount((int)headerCells.size()));
+                if(!isWanted(column))
+                    return true;
+
+                if(column >= (int)columns.size())
+                    columns.resize(column + 1);
+                auto &streamedColumn = columns[column];
+                if(!streamedColumn)
+                    streamedColumn = StreamedColumn{ makeColumnBuilder(columnType(column)) };
+
+                streamedColumn->fillMissingUpTo(row);
+                streamedColumn->builder->addFromCell(cell);
+                streamedColumn->rowCount++;
+                return true;
+            };
 
+            xlnt::streaming_workbook_reader reader;
+            reader.open(input);
+            if(activeTitle && reader.has_worksheet(*activeTitle))
+            {
+                reader.begin_worksheet(*activeTitle);
+                while(reader.has_cell())
+                    if(!consumeCell(reader.read_cell()))
+                        break;
+            }
+            else
+            {
+                reader.close();
+                input.clear();
+                input.seekg(0);
+
+                xlnt::workbook wb;
+                wb.load(input);
+                for(auto sheetRow : wb.active_sheet().rows())
+                    if(!std::all_of(sheetRow.begin(), sheetRow.end(), consumeCell))
+                        break;
+            }
+
+            const auto columnCount = (int)std::max(headerCells.size(), columns.size());
+            const auto names = namesForColumnCount(columnCount);
+            const auto selectedColumns = selectColumnIndices(options.columns, names);
+            const auto selectedNames = transformToVector(selectedColumns, [&](int column) { return names[column]; });
+            const auto selectedTypes = transformToVector(selectedColumns, columnType);
 
-            return buildTable(names, arrays, columnTypes);
+            std::vector<std::shared_ptr<arrow::Array>> arrays;
+            for(auto column : selectedColumns)
+            {
+                if(column >= (int)columns.size())
+                    columns.resize(column + 1);
+                auto &streamedColumn = columns[column];
+                if(!streamedColumn) // column without any cell
+                    streamedColumn = StreamedColumn{ makeColumnBuilder(columnType(column)) };
+
+                streamedColumn->fillMissingUpTo(rowCount);
+                arrays.push_back(streamedColumn->builder->finish());
+            }
 
+            return buildTable(selectedNames, arrays, selectedTypes);
         }
         catch(std::exception &e)
         {
@@ -237,7 +498,7 @@ std::shared_ptr<arrow::Table> FormatXLSX::read(std::string_view filePath, const
     try
     {
         auto input = openFileToRead(filePath);
-        return readXlsxInput(input, options.header, options.columnTypes);
+        return readXlsxInput(input, options);
     }
     catch(std::exception &e)
     {
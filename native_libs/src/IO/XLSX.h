@@ -10,7 +10,9 @@ namespace arrow
 struct XlsxReadOptions
 {
     HeaderPolicy header = TakeFirstRowAsHeaders{};
-    std::vector<ColumnType> columnTypes = {};
+    std::vector<ColumnType> columnTypes = {}; // types of the sheet columns (not only of the selected ones)
+    std::vector<ColumnSelector> columns = {}; // columns to be read, in the given order; empty means all
+    std::optional<int64_t> rowLimit; // maximum number of data rows to read (not counting the header)
 };
 
 struct XlsxWriteOptions
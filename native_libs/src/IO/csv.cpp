@@ -1,23 +1,40 @@
 #include "csv.h"
 #include "IO.h"
+#include "Compression.h"
+#include "CsvCache.h"
+#include "CsvScanner.h"
+#include "LoadJob.h"
+#include "MappedFile.h"
 #include "Core/ArrowUtilities.h"
 #include "Core/Logger.h"
+#include "Core/Parallel.h"
 #include "Core/Utils.h"
+#include "LQuery/AST.h"
+#include "LQuery/Interpreter.h"
 
 
 #include <algorithm>
+#include <charconv>
 #include <cinttypes>
 #include <cstdio>
+#include <cstring>
+#include <deque>
 #include <fstream>
+#include <future>
 #include <iomanip>
 #include <iostream>
 #include <map>
 #include <sstream>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
+#include <boost/filesystem.hpp>
+
+#include <arrow/record_batch.h>
 #include <arrow/table.h>
 #include <arrow/builder.h>
+#include <arrow/util/bit-util.h>
 
 using namespace std::literals;
 
@@ -40,14 +57,151 @@ arrow::Type::type deduceType(std::string_view text)
     return arrow::Type::STRING;
 }
 
-ParsedCsv parseCsvData(std::string data, char fieldSeparator /*= ','*/, char recordSeparator /*= '\n'*/, char quote /*= '"'*/)
+std::vector<char *> findCsvChunkBoundaries(char *bufferStart, char *bufferEnd, int maxChunkCount, char recordSeparator /*= '\n'*/, char quote /*= '"'*/)
+{
+    std::vector<char *> boundaries{bufferStart};
+
+    // Note: we assume that quote characters appear only in quoted fields (either delimiting them or escaped by doubling).
+    // Then being within quotes is just a matter of quote count parity -- escaped quotes don't change it.
+    const auto bufferLength = std::distance(bufferStart, bufferEnd);
+    char *scanned = bufferStart; // everything before this point has been already assigned to chunks
+    for(int i = 1; i < maxChunkCount && scanned < bufferEnd; i++)
+    {
+        const auto target = std::max(scanned, bufferStart + bufferLength * i / maxChunkCount);
+        bool inQuotes = std::count(scanned, target, quote) % 2 != 0;
+
+        // look for the first record separator outside quotes
+        scanned = findUnquotedSeparator(target, bufferEnd, recordSeparator, quote, inQuotes);
+
+        if(scanned >= bufferEnd)
+            break;
+
+        boundaries.push_back(++scanned); // new chunk starts after the separator
+    }
+
+    boundaries.push_back(bufferEnd);
+    return boundaries;
+}
+
+namespace
+{
+    ParsedCsv parseCsvBuffer(std::shared_ptr<void> bufferOwner, char *bufferStart, char *bufferEnd, char fieldSeparator, char recordSeparator, char quote, int threadCount, LoadProgress *progress)
+    {
+        // Each chunk is parsed by its own parser. As parser works in-place and chunks don't overlap, this is safe.
+        const auto boundaries = findCsvChunkBoundaries(bufferStart, bufferEnd, resolveThreadCount(threadCount), recordSeparator, quote);
+        std::vector<ParsedCsv::Chunk> chunks(boundaries.size() - 1);
+        parallelFor(chunks.size(), threadCount, [&] (int64_t chunkIndex)
+        {
+            CsvParser parser{boundaries[chunkIndex], boundaries[chunkIndex + 1], fieldSeparator, recordSeparator, quote};
+            chunks[chunkIndex] = parser.parseCsvTiles(CsvFieldTile::defaultRowCount, progress);
+        });
+
+        return { std::move(bufferOwner), std::move(chunks) };
+    }
+}
+
+ParsedCsv parseCsvData(std::string data, char fieldSeparator /*= ','*/, char recordSeparator /*= '\n'*/, char quote /*= '"'*/, int threadCount /*= 1*/, LoadProgress *progress /*= nullptr*/)
 {
     // we are going to return string_views inside buffer
     // and due to SSO that disallows us from moving std::string -- it needs to be single object
-    auto bufferPtr = std::make_unique<std::string>(std::move(data));
-    CsvParser parser{bufferPtr->data(), bufferPtr->data() + bufferPtr->size(), fieldSeparator, recordSeparator, quote};
-    auto table = parser.parseCsvTable();
-    return { std::move(bufferPtr), std::move(table) };
+    auto bufferPtr = std::make_shared<std::string>(std::move(data));
+    const auto bufferStart = bufferPtr->data();
+    const auto bufferEnd = bufferStart + bufferPtr->size();
+    return parseCsvBuffer(std::move(bufferPtr), bufferStart, bufferEnd, fieldSeparator, recordSeparator, quote, threadCount, progress);
+}
+
+ParsedCsv parseCsvFile(std::string_view filePath, char fieldSeparator /*= ','*/, char recordSeparator /*= '\n'*/, char quote /*= '"'*/, int threadCount /*= 1*/, LoadProgress *progress /*= nullptr*/)
+{
+    // Mapping is private, so the parser is free to write into it. Only pages it writes to are copied.
+    auto file = std::make_shared<MappedFile>(filePath, MappedFile::AccessPattern::Sequential);
+    const auto bufferStart = file->data();
+    const auto bufferEnd = bufferStart + file->size();
+    return parseCsvBuffer(std::move(file), bufferStart, bufferEnd, fieldSeparator, recordSeparator, quote, threadCount, progress);
+}
+
+namespace
+{
+    // Returns the length of the longest data prefix consisting of whole records, including their separators (0 if there is none).
+    // `inQuotesAtEnd` tells whether the data ends within a quoted field. Quotes are assumed to appear only in quoted fields.
+    size_t wholeRecordsLength(std::string_view data, char recordSeparator, char quote, bool inQuotesAtEnd)
+    {
+        bool inQuotes = inQuotesAtEnd;
+        for(auto i = data.size(); i-- > 0; )
+        {
+            if(data[i] == quote)
+                inQuotes = !inQuotes;
+            else if(data[i] == recordSeparator && !inQuotes)
+                return i + 1;
+        }
+        return 0;
+    }
+}
+
+ParsedCsv parseCompressedCsvFile(std::string_view filePath, char fieldSeparator /*= ','*/, char recordSeparator /*= '\n'*/, char quote /*= '"'*/, int threadCount /*= 1*/, size_t segmentSize /*= 16 << 20*/, LoadProgress *progress /*= nullptr*/, std::optional<Compression> compression /*= std::nullopt*/)
+{
+    if(resolveThreadCount(threadCount) == 1)
+        return parseCsvData(getDecompressedFileContents(filePath, compression), fieldSeparator, recordSeparator, quote, 1, progress);
+
+    if(segmentSize == 0)
+        THROW("segment size must be positive");
+
+    DecompressingReader reader{filePath, compression ? *compression : detectCompression(filePath)};
+
+    // The calling thread decompresses, the other ones parse segments that are already complete.
+    // Segments are kept in deque, so their buffers stay in place when further ones are appended.
+    const auto parserCount = (size_t)resolveThreadCount(threadCount) - 1;
+    auto segments = std::make_shared<std::deque<std::string>>();
+    std::vector<std::future<ParsedCsv::Chunk>> parsedSegments;
+    size_t finishedCount = 0; // segments known to be parsed, in order
+    const auto startParsing = [&] (std::string segment)
+    {
+        if(parsedSegments.size() - finishedCount >= parserCount)
+            parsedSegments[finishedCount++].wait();
+
+        auto &buffer = segments->emplace_back(std::move(segment));
+        const auto start = buffer.data();
+        const auto end = start + buffer.size();
+        parsedSegments.push_back(std::async(std::launch::async, [=]
+        {
+            CsvParser parser{start, end, fieldSeparator, recordSeparator, quote};
+            return parser.parseCsvTiles(CsvFieldTile::defaultRowCount, progress);
+        }));
+    };
+
+    const auto blockSize = std::min<size_t>(segmentSize, 1 << 20);
+    std::string pending; // decompressed data that has not been made into segments yet
+    bool inQuotes = false; // whether the end of pending data is within quoted field
+    while(true)
+    {
+        pending.reserve(segmentSize + blockSize);
+        const auto oldSize = pending.size();
+        pending.resize(oldSize + blockSize);
+        const auto readCount = reader.read(&pending[oldSize], blockSize);
+        pending.resize(oldSize + readCount);
+        inQuotes ^= std::count(pending.begin() + oldSize, pending.end(), quote) % 2 != 0;
+        if(progress)
+            progress->throwIfCancelled(); // pending parsers are awaited by the futures' destructors
+
+        if(readCount < blockSize)
+            break;
+        if(pending.size() < segmentSize)
+            continue;
+
+        // Segment ends outside quotes, so the quote state of the remaining data does not change.
+        if(const auto recordsLength = wholeRecordsLength(pending, recordSeparator, quote, inQuotes))
+        {
+            auto rest = pending.substr(recordsLength);
+            pending.resize(recordsLength);
+            startParsing(std::exchange(pending, std::move(rest)));
+        }
+    }
+
+    // the last record does not need to be terminated with a separator
+    if(pending.size())
+        startParsing(std::move(pending));
+
+    auto chunks = transformToVector(parsedSegments, [] (auto &parsed) { return parsed.get(); });
+    return { std::move(segments), std::move(chunks) };
 }
 
 enum class MissingField
@@ -148,20 +302,71 @@ struct ColumnBuilder
     {
         checkStatus(builder->Reserve(count));
     }
+    std::shared_ptr<arrow::Array> finish()
+    {
+        return ::finish(*builder);
+    }
 };
 
-ColumnType deduceType(const ParsedCsv &csv, size_t columnIndex, size_t startRow, size_t lookupDepth)
+// Builds dictionary-encoded string column: each distinct value is stored once, rows keep its 32-bit code.
+struct DictionaryColumnBuilder
 {
-    lookupDepth = std::min(lookupDepth, csv.records.size());
+    MissingField missingField;
+    arrow::StringBuilder dictionaryBuilder;
+    arrow::Int32Builder codeBuilder;
+    std::unordered_map<std::string_view, int32_t> codes; // views refer to the parsed buffer, that outlives the builder
+
+    explicit DictionaryColumnBuilder(MissingField missingField)
+        : missingField(missingField)
+    {}
+
+    NO_INLINE void addFromString(const std::string_view &field)
+    {
+        if(field.size())
+            addValue(field);
+        else
+            addMissing();
+    }
+    void addValue(std::string_view value)
+    {
+        const auto [itr, inserted] = codes.try_emplace(value, (int32_t)codes.size());
+        if(inserted)
+            checkStatus(append(dictionaryBuilder, value));
+        checkStatus(codeBuilder.Append(itr->second));
+    }
+    void addMissing()
+    {
+        if(missingField == MissingField::AsNull)
+            checkStatus(codeBuilder.AppendNull());
+        else
+            addValue(defaultValue<arrow::Type::STRING>());
+    }
+    void reserve(int64_t count)
+    {
+        checkStatus(codeBuilder.Reserve(count));
+    }
+    std::shared_ptr<arrow::Array> finish()
+    {
+        const auto type = arrow::dictionary(arrow::int32(), ::finish(dictionaryBuilder));
+        return std::make_shared<arrow::DictionaryArray>(type, ::finish(codeBuilder));
+    }
+};
 
+ColumnType deduceType(const std::vector<ParsedCsv::Chunk> &chunks, size_t columnIndex, size_t startRow, size_t lookupDepth)
+{
     std::unordered_set<arrow::Type::type> encounteredTypes;
-    for(size_t i = startRow; i < lookupDepth; i++)
+
+    // rows [startRow, lookupDepth) are considered, they can span many tiles and chunks
+    size_t row = 0;
+    for(auto &chunk : chunks)
     {
-        const auto &record = csv.records.at(i);
-        if(columnIndex < record.size())
+        for(auto &tile : chunk)
         {
-            const auto field = record.at(columnIndex);
-            encounteredTypes.insert(deduceType(field));
+            for(size_t tileRow = 0; tileRow < tile.rowCount && row < lookupDepth; ++tileRow, ++row)
+            {
+                if(row >= startRow && tile.hasField(columnIndex, tileRow))
+                    encounteredTypes.insert(deduceType(tile.field(columnIndex, tileRow)));
+            }
         }
     }
 
@@ -187,50 +392,126 @@ ColumnType deduceType(const ParsedCsv &csv, size_t columnIndex, size_t startRow,
     return ColumnType{typePtr, encounteredTypes.count(arrow::Type::NA) > 0, true};
 }
 
-std::shared_ptr<arrow::Table> csvToArrowTable(const ParsedCsv &csv, HeaderPolicy header, std::vector<ColumnType> columnTypes, int typeDeductionDepth)
+// Heuristic for automatic dictionary encoding: string column is deemed categorical when
+// at most half of the sampled values are distinct. Looks at rows [startRow, lookupDepth) like `deduceType`.
+bool looksCategorical(const std::vector<ParsedCsv::Chunk> &chunks, size_t columnIndex, size_t startRow, size_t lookupDepth)
 {
-    // empty table
-    if(csv.recordCount == 0 || csv.fieldCount == 0)
+    constexpr size_t minimalSampleSize = 16; // too few values don't tell anything
+    lookupDepth = std::max<size_t>(lookupDepth, 1000); // type is known after a few rows, but repetitions need more of them
+
+    std::unordered_set<std::string_view> distinctValues;
+    size_t sampleSize = 0;
+    size_t row = 0;
+    for(auto &chunk : chunks)
     {
-        auto schema = std::make_shared<arrow::Schema>(std::vector<std::shared_ptr<arrow::Field>>{});
-        return arrow::Table::Make(schema, std::vector<std::shared_ptr<arrow::Array>>{});
+        for(auto &tile : chunk)
+        {
+            for(size_t tileRow = 0; tileRow < tile.rowCount && row < lookupDepth; ++tileRow, ++row)
+            {
+                if(row >= startRow && tile.hasField(columnIndex, tileRow))
+                {
+                    if(const auto field = tile.field(columnIndex, tileRow); field.size())
+                    {
+                        distinctValues.insert(field);
+                        ++sampleSize;
+                    }
+                }
+            }
+        }
     }
 
-    std::vector<std::shared_ptr<arrow::Array>> arrays;
-    arrays.reserve(csv.fieldCount);
+    return sampleSize >= minimalSampleSize && distinctValues.size() * 2 <= sampleSize;
+}
 
-    const bool takeFirstRowAsNames = holds_alternative<TakeFirstRowAsHeaders>(header);
-    const int startRow = takeFirstRowAsNames ? 1 : 0;
+bool shouldEncodeDictionary(DictionaryEncoding encoding, const ColumnType &type, const std::function<bool()> &isCategorical)
+{
+    if(type.type->id() != arrow::Type::STRING)
+        return false;
 
-    // Attempt to deduce all non-specified types
-    for(size_t i = columnTypes.size(); i < csv.fieldCount; i++)
+    switch(encoding)
     {
-        columnTypes.push_back(deduceType(csv, i, startRow, typeDeductionDepth));
+    case DictionaryEncoding::Never    : return false;
+    case DictionaryEncoding::Automatic: return isCategorical();
+    case DictionaryEncoding::Always   : return true;
+    default: THROW("invalid dictionary encoding value: {}", (int)encoding);
     }
+}
+
+size_t rowCount(const std::vector<CsvFieldTile> &tiles)
+{
+    size_t ret = 0;
+    for(auto &tile : tiles)
+        ret += tile.rowCount;
+    return ret;
+}
+
+// Returns number of rows in [startRow, rowCount(tiles)) that are set in the mask (nullptr mask selects all).
+size_t selectedRowCount(const std::vector<CsvFieldTile> &tiles, size_t startRow, const uint8_t *rowMask)
+{
+    const auto totalRowCount = rowCount(tiles);
+    const auto length = totalRowCount - std::min(startRow, totalRowCount);
+    return rowMask ? (size_t)arrow::CountSetBits(rowMask, 0, length) : length;
+}
+
+// Builds arrays only for the given columns, `columnTypes` are parallel to `columns`. Fields of other columns are not even looked at.
+// If `rowMask` is given, its i-th bit tells whether the i-th row since `startRow` should be included.
+// Columns flagged in `dictionaryEncoded` (parallel to `columns`, may be empty) yield dictionary arrays with chunk's own dictionary.
+std::vector<std::shared_ptr<arrow::Array>> buildCsvArrays(const std::vector<CsvFieldTile> &tiles, size_t startRow, const std::vector<int> &columns, const std::vector<ColumnType> &columnTypes, const uint8_t *rowMask = nullptr, const std::vector<bool> &dictionaryEncoded = {})
+{
+    std::vector<std::shared_ptr<arrow::Array>> arrays;
+    arrays.reserve(columns.size());
 
-    for(int column = 0; column < csv.fieldCount; column++)
+    const auto outputRowCount = selectedRowCount(tiles, startRow, rowMask);
+
+    for(size_t i = 0; i < columns.size(); i++)
     {
-        const auto typeInfo = columnTypes.at(column);
+        const size_t column = columns[i];
+        const auto typeInfo = columnTypes.at(i);
         const auto missingFieldsPolicy = (typeInfo.deduced || typeInfo.nullable) ? MissingField::AsNull : MissingField::AsZeroValue;
         auto processColumn = [&] (auto &&builder)
         {
-            builder.reserve(csv.recordCount);
-            for(int row = startRow; row < csv.recordCount; row++)
+            builder.reserve(outputRowCount);
+
+            // only the first tile may contain the skipped rows
+            size_t skippedRows = startRow;
+            size_t maskIndex = 0;
+            for(auto &tile : tiles)
             {
-                const auto &record = csv.records[row];
-                if(column < record.size())
+                const auto firstRow = std::min(skippedRows, tile.rowCount);
+                skippedRows -= firstRow;
+
+                if(column < tile.columnCount)
                 {
-                    const auto &field = csv.records[row][column];
-                    builder.addFromString(field);
+                    // fields of the column are contiguous within tile
+                    const auto base = tile.base;
+                    const auto offsets = tile.offsets.data() + column * tile.rowCount;
+                    const auto lengths = tile.lengths.data() + column * tile.rowCount;
+                    for(size_t row = firstRow; row < tile.rowCount; row++, maskIndex++)
+                    {
+                        if(rowMask && !arrow::BitUtil::GetBit(rowMask, maskIndex))
+                            continue;
+                        if(lengths[row] != CsvFieldTile::missing)
+                            builder.addFromString(std::string_view{base + offsets[row], lengths[row]});
+                        else
+                            builder.addMissing();
+                    }
                 }
                 else
                 {
-                    builder.addMissing();
+                    for(size_t row = firstRow; row < tile.rowCount; row++, maskIndex++)
+                        if(!rowMask || arrow::BitUtil::GetBit(rowMask, maskIndex))
+                            builder.addMissing();
                 }
             }
-            arrays.push_back(finish(*builder.builder));
+            arrays.push_back(builder.finish());
         };
 
+        if(i < dictionaryEncoded.size() && dictionaryEncoded[i])
+        {
+            processColumn(DictionaryColumnBuilder{missingFieldsPolicy});
+            continue;
+        }
+
         visitDataType(typeInfo.type, [&] (auto type)
         {
             constexpr auto id = idFromDataPointer<decltype(type)>;
@@ -241,220 +522,386 @@ std::shared_ptr<arrow::Table> csvToArrowTable(const ParsedCsv &csv, HeaderPolicy
         });
     }
 
-    const auto names = decideColumnNames((int)csv.fieldCount, header, [&] (int column)
+    return arrays;
+}
+
+// LQuery predicate evaluated on parsed CSV fields, before the output columns are built.
+// Only the columns referenced by the predicate are converted to evaluate it.
+class CsvRowFilter
+{
+public:
+    CsvRowFilter(const char *predicateJson, const std::vector<std::string> &fileColumnNames, const std::function<ColumnType(int)> &fileColumnType)
+        : parsed(parseAgainstNames(predicateJson, fileColumnNames))
+    {
+        // The predicate was parsed against all file columns, now it needs to refer to the evaluated ones.
+        for(auto &[referenceId, columnIndex] : parsed.first)
+        {
+            columns.push_back(columnIndex);
+            columnTypes.push_back(fileColumnType(columnIndex));
+            fields.push_back(arrow::field(fileColumnNames.at(columnIndex), columnTypes.back().type));
+            columnIndex = (int)columns.size() - 1;
+        }
+    }
+
+    // Returns bitmask of rows since `startRow` that satisfy the predicate (nullptr if there are no such rows to check).
+    std::shared_ptr<arrow::Buffer> evaluate(const std::vector<CsvFieldTile> &tiles, size_t startRow) const
+    {
+        if(rowCount(tiles) <= startRow)
+            return nullptr;
+
+        const auto arrays = buildCsvArrays(tiles, startRow, columns, columnTypes);
+        const auto table = arrow::Table::Make(arrow::schema(fields), arrays);
+        return execute(*table, parsed.second, parsed.first);
+    }
+
+private:
+    std::pair<ColumnMapping, ast::Predicate> parsed; // mapping refers to the `columns` positions
+    std::vector<int> columns; // file columns used by the predicate
+    std::vector<ColumnType> columnTypes;
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+
+    static std::pair<ColumnMapping, ast::Predicate> parseAgainstNames(const char *predicateJson, const std::vector<std::string> &names)
+    {
+        // Parser only needs to look up columns by names, so their types and contents don't matter yet.
+        const auto emptyArray = makeNullsArray(arrow::utf8(), 0);
+        const auto columns = transformToVector(names, [&] (const std::string &name)
+        {
+            return std::make_shared<arrow::Column>(arrow::field(name, arrow::utf8()), emptyArray);
+        });
+        const auto fields = transformToVector(columns, [] (auto &&column) { return column->field(); });
+        const auto table = arrow::Table::Make(arrow::schema(fields), columns);
+        return ast::parsePredicate(*table, predicateJson);
+    }
+};
+
+std::shared_ptr<arrow::Table> csvToArrowTable(const ParsedCsv &csv, HeaderPolicy header, std::vector<ColumnType> columnTypes, int typeDeductionDepth, int threadCount /*= 1*/, const std::vector<ColumnSelector> &columns /*= {}*/, const char *predicate /*= nullptr*/, DictionaryEncoding dictionaryEncoding /*= DictionaryEncoding::Never*/)
+{
+    // empty table
+    if(csv.recordCount == 0 || csv.fieldCount == 0)
+    {
+        auto schema = std::make_shared<arrow::Schema>(std::vector<std::shared_ptr<arrow::Field>>{});
+        return arrow::Table::Make(schema, std::vector<std::shared_ptr<arrow::Array>>{});
+    }
+
+    const bool takeFirstRowAsNames = holds_alternative<TakeFirstRowAsHeaders>(header);
+    const int startRow = takeFirstRowAsNames ? 1 : 0;
+
+    const auto fileColumnNames = decideColumnNames((int)csv.fieldCount, header, [&] (int column)
     {
-        const auto &headerRow = csv.records[0];
-        if(column < (int)headerRow.size())
-            return std::string(headerRow[column]);
+        const auto &headerTile = csv.chunks.front().front();
+        if(headerTile.hasField(column, 0))
+            return std::string(headerTile.field(column, 0));
         else
             return ""s;
     });
-    
-    return buildTable(names, arrays, columnTypes);
+
+    const auto selectedColumns = selectColumnIndices(columns, fileColumnNames);
+    const auto names = transformToVector(selectedColumns, [&] (int column) { return fileColumnNames[column]; });
+
+    // Attempt to deduce all non-specified types (columns that are neither selected nor filtered on don't need them)
+    const auto columnType = [&] (int column)
+    {
+        if(column < columnTypes.size())
+            return columnTypes[column];
+        return deduceType(csv.chunks, column, startRow, typeDeductionDepth);
+    };
+    auto selectedTypes = transformToVector(selectedColumns, columnType);
+    const auto rowFilter = predicate ? std::make_unique<CsvRowFilter>(predicate, fileColumnNames, columnType) : nullptr;
+
+    std::vector<bool> dictionaryEncoded;
+    for(size_t i = 0; i < selectedColumns.size(); i++)
+    {
+        dictionaryEncoded.push_back(shouldEncodeDictionary(dictionaryEncoding, selectedTypes[i], [&]
+        {
+            return looksCategorical(csv.chunks, selectedColumns[i], startRow, typeDeductionDepth);
+        }));
+    }
+
+    // Each parsed chunk yields its own arrays. Only the first chunk may contain the header row.
+    std::vector<std::vector<std::shared_ptr<arrow::Array>>> arraysPerChunk(csv.chunks.size());
+    parallelFor(csv.chunks.size(), threadCount, [&] (int64_t chunkIndex)
+    {
+        const auto &tiles = csv.chunks[chunkIndex];
+        const auto chunkStartRow = chunkIndex == 0 ? startRow : 0;
+        const auto rowMask = rowFilter ? rowFilter->evaluate(tiles, chunkStartRow) : nullptr;
+        arraysPerChunk[chunkIndex] = buildCsvArrays(tiles, chunkStartRow, selectedColumns, selectedTypes, rowMask ? rowMask->data() : nullptr, dictionaryEncoded);
+    });
+
+    if(arraysPerChunk.size() == 1)
+    {
+        for(size_t column = 0; column < selectedColumns.size(); column++)
+            if(dictionaryEncoded[column])
+                selectedTypes[column].type = arraysPerChunk.front().at(column)->type();
+
+        return buildTable(names, arraysPerChunk.front(), selectedTypes);
+    }
+
+    std::vector<std::shared_ptr<arrow::ChunkedArray>> chunkedArrays;
+    for(size_t column = 0; column < selectedColumns.size(); column++)
+    {
+        auto chunks = transformToVector(arraysPerChunk, [&] (auto &&arrays) { return arrays.at(column); });
+        if(dictionaryEncoded[column])
+        {
+            // dictionary is a part of the type, so all chunks need to share it
+            chunks = unifyDictionaries(chunks);
+            selectedTypes[column].type = chunks.front()->type();
+        }
+        chunkedArrays.push_back(std::make_shared<arrow::ChunkedArray>(chunks));
+    }
+
+    return buildTable(names, chunkedArrays, selectedTypes);
 }
 
-ParsedCsv::ParsedCsv(std::unique_ptr<std::string> buffer, Table records_)
+ParsedCsv::ParsedCsv(std::shared_ptr<void> buffer, std::vector<Chunk> chunks_)
     : buffer(std::move(buffer))
-    , records(std::move(records_))
+    , chunks(std::move(chunks_))
 {
-    recordCount = records.size();
+    if(chunks.empty())
+        chunks.emplace_back();
 
-    const auto biggestRecord = std::max_element(records.begin(), records.end(), 
-        [] (auto &record1, auto &record2) 
-            { return record1.size() < record2.size(); });
-    
-    if(biggestRecord != records.end())
-        fieldCount = biggestRecord->size();
+    for(auto &chunk : chunks)
+    {
+        for(auto &tile : chunk)
+        {
+            recordCount += tile.rowCount;
+            fieldCount = std::max(fieldCount, tile.columnCount);
+        }
+    }
 }
 
-struct CsvGenerator
+// Formats CSV fields, applying quoting when needed. Fields are appended to memory buffers.
+struct CsvFieldFormatter
 {
-    std::ostream &out;
     GeneratorQuotingPolicy quotingPolicy;
     char fieldSeparator = ',';
     char recordSeparator = '\n';
     char quote = '"';
+    bool numbersMayNeedQuoting = false; // whether special characters may appear in formatted numbers and dates
 
-    explicit CsvGenerator(std::ostream &out, GeneratorQuotingPolicy quotingPolicy, char fieldSeparator = ',', char recordSeparator = '\n', char quote = '"') 
-        : out(out)
-        , quotingPolicy(quotingPolicy)
+    CsvFieldFormatter(GeneratorQuotingPolicy quotingPolicy, char fieldSeparator, char recordSeparator, char quote)
+        : quotingPolicy(quotingPolicy)
         , fieldSeparator(fieldSeparator)
         , recordSeparator(recordSeparator)
         , quote(quote)
-    {}
+    {
+        constexpr std::string_view numericCharacters = "+-.0123456789abcdefinpstxyEIN"; // includes "nan", "inf" and exponents
+        for(auto c : { fieldSeparator, recordSeparator, quote })
+            numbersMayNeedQuoting = numbersMayNeedQuoting || numericCharacters.find(c) != std::string_view::npos;
+    }
 
-    bool needsEscaping(const char *data, int32_t length) const
+    // If caller knows that field cannot contain special characters, only its leading and trailing spaces are checked.
+    bool needsQuoting(std::string_view field, bool mayContainSpecialCharacters) const
     {
-        if(length == 0)
+        if(quotingPolicy == GeneratorQuotingPolicy::QueteAllFields)
+            return true;
+        if(field.empty())
             return false;
-
-        if(data[0] == ' ' || data[length-1] == ' ')
+        if(field.front() == ' ' || field.back() == ' ')
             return true;
 
-        for(int i = 0; i < length; i++)
+        const auto end = field.data() + field.size();
+        return mayContainSpecialCharacters && findFirstOf(field.data(), end, fieldSeparator, recordSeparator, quote) != end;
+    }
+
+    void write(std::string &out, std::string_view field, bool mayContainSpecialCharacters = true) const
+    {
+        if(!needsQuoting(field, mayContainSpecialCharacters))
         {
-            char c = data[i];
-            if(c == fieldSeparator || c == recordSeparator || c == quote)
-                return true;
+            out.append(field.data(), field.size());
+            return;
         }
 
-        return false;
-    };
-
-    void writeField(const char *data, int32_t length)
-    {
-        if(quotingPolicy == GeneratorQuotingPolicy::QueteAllFields || needsEscaping(data, length))
+        // quotes within field are escaped by doubling them
+        out += quote;
+        for(auto c : field)
         {
-            // TODO workaround for mac
-        #ifdef _MSC_VER
-            out << std::quoted(std::string_view(data, length), quote, quote);            
-        #else
-            out << std::quoted(std::string{data, data + length}, quote, quote);
-        #endif
+            if(c == quote)
+                out += quote;
+            out += c;
         }
-        else
-            out.write(data, length);
-    };
+        out += quote;
+    }
 };
 
-struct ColumnWriter
+// Writes decimal representation of the value at `out`, returns pointer past the last written character.
+char *formatInteger(char *out, int64_t value)
 {
-    char buffer[256];
+    char digits[20];
+    int digitCount = 0;
+    auto magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    do
+    {
+        digits[digitCount++] = char('0' + magnitude % 10);
+        magnitude /= 10;
+    } while(magnitude);
+
+    if(value < 0)
+        *out++ = '-';
+    while(digitCount)
+        *out++ = digits[--digitCount];
+    return out;
+}
 
-    std::vector<std::shared_ptr<arrow::Array>> chunks;
+// Same as printf "%lf", i.e. fixed notation with 6 decimal digits.
+char *formatDouble(char *out, char *outEnd, double value)
+{
+#if __cpp_lib_to_chars >= 201611 || _MSC_VER >= 1915
+    return std::to_chars(out, outEnd, value, std::chars_format::fixed, 6).ptr;
+#else
+    return out + std::snprintf(out, outEnd - out, "%lf", value);
+#endif
+}
 
-    int currentChunk = 0;
-    int usedFromChunk = 0;
+// Same as strftime "%F", i.e. YYYY-MM-DD (only the date part of timestamp is written).
+char *formatDate(char *out, Timestamp timestamp)
+{
+    const auto ymd = timestamp.ymd();
+    const auto month = static_cast<unsigned>(ymd.month());
+    const auto day = static_cast<unsigned>(ymd.day());
+    out = formatInteger(out, static_cast<int>(ymd.year()));
+    *out++ = '-';
+    *out++ = char('0' + month / 10);
+    *out++ = char('0' + month % 10);
+    *out++ = '-';
+    *out++ = char('0' + day / 10);
+    *out++ = char('0' + day % 10);
+    return out;
+}
 
-    int32_t helper;
+// Whether any of the string values in array (or its dictionary) contains characters requiring quoting.
+// One vectorized scan of the whole value buffer spares checking each field separately.
+bool stringsMayNeedQuoting(const arrow::Array &array, const CsvFieldFormatter &formatter)
+{
+    if(array.type_id() == arrow::Type::DICTIONARY)
+        return stringsMayNeedQuoting(*static_cast<const arrow::DictionaryArray &>(array).dictionary(), formatter);
 
-    ColumnWriter(const std::shared_ptr<arrow::ChunkedArray> &chunkedArray)
-        : chunks(chunkedArray->chunks())
-    {}
-    virtual ~ColumnWriter() {}
+    const auto &strings = static_cast<const arrow::StringArray &>(array);
+    if(strings.length() == 0)
+        return false;
 
-    virtual void consumeFromChunk(const arrow::Array &chunk, CsvGenerator &generator) = 0;
+    const auto data = reinterpret_cast<const char *>(strings.value_data()->data());
+    const auto begin = data + strings.value_offset(0);
+    const auto end = data + strings.value_offset(strings.length());
+    return findFirstOf(begin, end, formatter.fieldSeparator, formatter.recordSeparator, formatter.quote) != end;
+}
 
-    void consumeField(CsvGenerator &generator)
-    {
-        const auto &chunk = chunks[currentChunk];
-        if(!chunk->IsNull(usedFromChunk))
-        {
-            consumeFromChunk(*chunk, generator);
-        }
-        
-        if(++usedFromChunk >= chunk->length())
-            currentChunk++;
-    }
+// Formatted fields of a single column within a range of rows.
+struct FormattedColumn
+{
+    std::string text;
+    std::vector<size_t> fieldEnds; // [row] => end of the row's field in `text`, it starts where the previous one ends
 };
 
-// Note: type below is meant to be specialzied for supported types
 template<arrow::Type::type id>
-struct ColumnWriterFor 
+void formatFields(const arrow::Array &array, const CsvFieldFormatter &formatter, FormattedColumn &out)
 {
-};
+    char buffer[512];
+    auto mayContainSpecialCharacters = formatter.numbersMayNeedQuoting;
+    if constexpr(id == arrow::Type::STRING)
+        mayContainSpecialCharacters = stringsMayNeedQuoting(array, formatter);
 
-template<>
-struct ColumnWriterFor<arrow::Type::STRING> : ColumnWriter
-{
-    using ColumnWriter::ColumnWriter;
-    virtual void consumeFromChunk(const arrow::Array &chunk, CsvGenerator &generator)
-    {
-        auto ptr = static_cast<const arrow::StringArray&>(chunk).GetValue(usedFromChunk, &helper);
-        generator.writeField(reinterpret_cast<const char*>(ptr), helper);
+    iterateOver<id>(array,
+        [&] (auto &&value)
+        {
+            if constexpr(id == arrow::Type::STRING)
+                formatter.write(out.text, value, mayContainSpecialCharacters);
+            else if constexpr(id == arrow::Type::INT64)
+                formatter.write(out.text, std::string_view(buffer, formatInteger(buffer, value) - buffer), mayContainSpecialCharacters);
+            else if constexpr(id == arrow::Type::DOUBLE)
+                formatter.write(out.text, std::string_view(buffer, formatDouble(buffer, std::end(buffer), value) - buffer), mayContainSpecialCharacters);
+            else if constexpr(id == arrow::Type::TIMESTAMP)
+                formatter.write(out.text, std::string_view(buffer, formatDate(buffer, value) - buffer), mayContainSpecialCharacters);
+            else
+                static_assert(always_false2_v<id>, "wrong type");
 
-    }
-};
+            out.fieldEnds.push_back(out.text.size());
+        },
+        [&]
+        {
+            out.fieldEnds.push_back(out.text.size());
+        });
+}
 
-template<>
-struct ColumnWriterFor<arrow::Type::INT64> : ColumnWriter
+// Formats rows [beginRow, endRow) of the table. Each row but the very first one in table is preceded by the record separator.
+std::string formatCsvRows(const arrow::Table &table, int64_t beginRow, int64_t endRow, const CsvFieldFormatter &formatter)
 {
-    using ColumnWriter::ColumnWriter;
-    virtual void consumeFromChunk(const arrow::Array &chunk, CsvGenerator &generator)
+    // Fields are formatted column by column, so type is dispatched only once per chunk. Then they are interleaved into records.
+    std::vector<FormattedColumn> columns(table.num_columns());
+    size_t totalTextLength = 0;
+    for(int column = 0; column < table.num_columns(); column++)
     {
-        auto value = static_cast<const arrow::Int64Array&>(chunk).Value(usedFromChunk);
-        auto n = std::snprintf(buffer, std::size(buffer), "%" PRId64, value);
-        generator.writeField(buffer, n);
-
+        auto &formatted = columns[column];
+        formatted.fieldEnds.reserve(endRow - beginRow);
+        const auto slice = table.column(column)->Slice(beginRow, endRow - beginRow);
+        for(auto &chunk : slice->data()->chunks())
+        {
+            visitType(*chunk->type(), [&] (auto id)
+            {
+                formatFields<id.value>(*chunk, formatter, formatted);
+            });
+        }
+        totalTextLength += formatted.text.size();
     }
-};
 
-template<>
-struct ColumnWriterFor<arrow::Type::DOUBLE> : ColumnWriter
-{
-    using ColumnWriter::ColumnWriter;
-    virtual void consumeFromChunk(const arrow::Array &chunk, CsvGenerator &generator)
+    std::string out;
+    out.reserve(totalTextLength + (endRow - beginRow) * table.num_columns());
+    for(int64_t row = 0; row < endRow - beginRow; row++)
     {
-        auto value = static_cast<const arrow::DoubleArray&>(chunk).Value(usedFromChunk);
-        auto n = std::snprintf(buffer, std::size(buffer), "%lf", value);
-        generator.writeField(buffer, n);
-
-    }
-};
+        if(beginRow + row)
+            out += formatter.recordSeparator;
 
-template<>
-struct ColumnWriterFor<arrow::Type::TIMESTAMP> : ColumnWriter
-{
-    using ColumnWriter::ColumnWriter;
-    virtual void consumeFromChunk(const arrow::Array &chunk, CsvGenerator &generator)
-    {
-        // TODO support other timestamp units 
-        assert(std::dynamic_pointer_cast<arrow::TimestampType>(chunk.type())->unit() == arrow::TimeUnit::NANO);
-        auto ticksCount = static_cast<const arrow::TimestampArray&>(chunk).Value(usedFromChunk);
-        TimestampDuration nanosecondTicks(ticksCount);
-        Timestamp timestamp(nanosecondTicks);
-        auto timet = timestamp.toTimeT();
-        auto tm = std::gmtime(&timet);
-        auto n = std::strftime(buffer, std::size(buffer), "%F", tm);
-        generator.writeField(buffer, n);
+        for(size_t column = 0; column < columns.size(); column++)
+        {
+            if(column)
+                out += formatter.fieldSeparator;
 
+            const auto &formatted = columns[column];
+            const auto fieldStart = row ? formatted.fieldEnds[row - 1] : 0;
+            out.append(formatted.text, fieldStart, formatted.fieldEnds[row] - fieldStart);
+        }
     }
-};
+    return out;
+}
 
-void generateCsv(std::ostream &out, const arrow::Table &table, GeneratorHeaderPolicy headerPolicy, GeneratorQuotingPolicy quotingPolicy, char fieldSeparator /*= ','*/, char recordSeparator /*= '\n'*/, char quote /*= '"'*/)
+void generateCsv(std::ostream &out, const arrow::Table &table, GeneratorHeaderPolicy headerPolicy, GeneratorQuotingPolicy quotingPolicy, char fieldSeparator /*= ','*/, char recordSeparator /*= '\n'*/, char quote /*= '"'*/, int threadCount /*= 1*/)
 {
-    CsvGenerator generator{out, quotingPolicy, fieldSeparator, recordSeparator, quote};
-
-    std::vector<std::unique_ptr<ColumnWriter>> writers;
-    writers.reserve(table.num_columns());
+    const CsvFieldFormatter formatter{quotingPolicy, fieldSeparator, recordSeparator, quote};
 
     if(headerPolicy == GeneratorHeaderPolicy::GenerateHeaderLine)
     {
+        std::string header;
         for(int column = 0; column < table.num_columns(); column++)
         {
             if(column)
-                out << fieldSeparator;
+                header += fieldSeparator;
 
-            const auto c = table.column(column);
-            const auto &name = c->name();
-            generator.writeField(name.data(), (int)name.size());
+            formatter.write(header, table.column(column)->name());
         }
 
-        out << recordSeparator;
+        header += recordSeparator;
+        out.write(header.data(), header.size());
     }
 
-    for(int column = 0; column < table.num_columns(); column++)
-    {
-        const auto c = table.column(column);
-        visitType(*c->type(), [&] (auto id)
-        {
-            writers.push_back(std::make_unique<ColumnWriterFor<id.value>>(c->data()));
-        });
-    }
+    // Rows are formatted in blocks, each into its own buffer. Workers format a batch of blocks,
+    // that are then written in order, so memory use is bounded regardless of the table size.
+    constexpr int64_t rowsPerBlock = 16384;
+    const auto rowCount = table.num_rows();
+    const auto blockCount = (rowCount + rowsPerBlock - 1) / rowsPerBlock;
+    const auto blocksPerBatch = std::max<int64_t>(4 * resolveThreadCount(threadCount), 1);
 
-    // write records
-    for(int row = 0; row < table.num_rows(); row++)
+    std::vector<std::string> formattedBlocks(std::min(blockCount, blocksPerBatch));
+    for(int64_t batchStart = 0; batchStart < blockCount; batchStart += blocksPerBatch)
     {
-        if(row)
-            out << recordSeparator;
-
-        for(int column = 0; column < table.num_columns(); column++)
+        const auto batchBlockCount = std::min(blocksPerBatch, blockCount - batchStart);
+        parallelFor(batchBlockCount, threadCount, [&] (int64_t i)
         {
-            if(column)
-                out << fieldSeparator;
+            const auto beginRow = (batchStart + i) * rowsPerBlock;
+            const auto endRow = std::min(beginRow + rowsPerBlock, rowCount);
+            formattedBlocks[i] = formatCsvRows(table, beginRow, endRow, formatter);
+        });
 
-            writers[column]->consumeField(generator);
-        }
+        for(int64_t i = 0; i < batchBlockCount; i++)
+            out.write(formattedBlocks[i].data(), formattedBlocks[i].size());
     }
 }
 
@@ -488,18 +935,25 @@ std::string_view CsvParser::parseField()
     // Just consume text until separator is encountered
     if(!quoted)
     {
+        // CR is a candidate only when we treat CRLF as if LF
+        const auto carriageReturn = recordSeparator == '\n' ? '\r' : recordSeparator;
         const auto start = bufferIterator;
-        for(; bufferIterator != bufferEnd; ++bufferIterator)
+        while(true)
         {
+            bufferIterator = findFirstOf(bufferIterator, bufferEnd, fieldSeparator, recordSeparator, carriageReturn);
+            if(bufferIterator == bufferEnd)
+                break;
+
             char c = *bufferIterator;
             if(c == fieldSeparator || c == recordSeparator)
                 break;
-            if(recordSeparator == '\n' && c == '\r') // treat CRLF as if LF
-            {
-                auto nextItr = bufferIterator+1;
-                if(nextItr != bufferEnd  &&  *nextItr == '\n')
-                    break;
-            }
+
+            // c is CR: it ends the field only when followed by LF
+            auto nextItr = bufferIterator+1;
+            if(nextItr != bufferEnd  &&  *nextItr == '\n')
+                break;
+
+            bufferIterator = nextItr;
         }
         return std::string_view(start, std::distance(start, bufferIterator));
     }
@@ -510,62 +964,67 @@ std::string_view CsvParser::parseField()
 
     int rewriteOffset = 0;
 
-    for(; bufferIterator != bufferEnd; ++bufferIterator)
+    // Jump from quote to quote -- everything between them is field contents.
+    while(auto quoteItr = static_cast<char *>(std::memchr(bufferIterator, quote, std::distance(bufferIterator, bufferEnd))))
     {
-        char c = *bufferIterator;
+        // Escaped quotes are collapsed, so the following contents needs to be moved back
+        if(rewriteOffset)
+            std::memmove(bufferIterator - rewriteOffset, bufferIterator, std::distance(bufferIterator, quoteItr));
+
+        bufferIterator = quoteItr;
 
-        if(c == quote)
+        // Either field terminator or nested double quote
+        const auto nextIterator = bufferIterator+1;
+        const auto nextIsAlsoQuote = nextIterator!=bufferEnd && *nextIterator == quote;
+        if(nextIsAlsoQuote)
         {
-            // Either field terminator or nested double quote
-            const auto nextIterator = bufferIterator+1;
-            const auto nextIsAlsoQuote = nextIterator!=bufferEnd && *nextIterator == quote;
-            if(nextIsAlsoQuote)
-            {
-                ++rewriteOffset;
-                ++bufferIterator;
-            }
-            else
-            {
-                auto length = std::distance(start, bufferIterator++);
-                return std::string_view(start, length - rewriteOffset);
-            }
+            *(bufferIterator - rewriteOffset) = quote;
+            ++rewriteOffset;
+            bufferIterator += 2;
+        }
+        else
+        {
+            auto length = std::distance(start, bufferIterator++);
+            return std::string_view(start, length - rewriteOffset);
         }
-
-        if(rewriteOffset)
-            *(bufferIterator - rewriteOffset) = c;
     }
 
     throw std::runtime_error("reached the end of the file with an unmatched quote character");
 }
 
-std::vector<std::string_view> CsvParser::parseRecord()
+template<typename FieldHandler>
+void CsvParser::parseRecordFields(FieldHandler &&handleField)
 {
-    std::vector<std::string_view> ret;
-    ret.reserve(lastColumnCount);
     while(true)
     {
-        char initialCharacter = *bufferIterator;
-
-        ret.push_back(parseField());
+        handleField(parseField());
 
         if(bufferIterator >= bufferEnd)
-            return ret;
+            return;
 
         const auto next = *bufferIterator++;
         if(next == recordSeparator)
-            return ret;
+            return;
         if(next == '\r' && recordSeparator == '\n')
         {
             if(bufferIterator >= bufferEnd)
-                return ret;
+                return;
 
             const auto next = *bufferIterator++;
             if(next == '\n')
-                return ret;
+                return;
         }
     }
 }
 
+std::vector<std::string_view> CsvParser::parseRecord()
+{
+    std::vector<std::string_view> ret;
+    ret.reserve(lastColumnCount);
+    parseRecordFields([&] (std::string_view field) { ret.push_back(field); });
+    return ret;
+}
+
 std::vector<std::vector<std::string_view>> CsvParser::parseCsvTable()
 {
     std::vector<std::vector<std::string_view>> ret;
@@ -580,16 +1039,268 @@ std::vector<std::vector<std::string_view>> CsvParser::parseCsvTable()
     return ret;
 }
 
+namespace
+{
+    // Collects fields record by record (row-major) and transposes them into a column-major tile.
+    // Buffers are reused between tiles, so in the long run parsing doesn't allocate per record.
+    class CsvTileBuilder
+    {
+        char *base{};
+        std::vector<uint32_t> offsets; // fields of consecutive records
+        std::vector<uint32_t> lengths;
+        std::vector<size_t> recordEnds; // index one past the last field of each record
+        size_t columnCount{};
+
+    public:
+        void start(char *tileBase)
+        {
+            base = tileBase;
+            offsets.clear();
+            lengths.clear();
+            recordEnds.clear();
+            columnCount = 0;
+        }
+
+        size_t rowCount() const
+        {
+            return recordEnds.size();
+        }
+
+        void addField(std::string_view field)
+        {
+            const auto offset = static_cast<size_t>(std::distance<const char *>(base, field.data()));
+            if(offset + field.size() >= CsvFieldTile::missing)
+                THROW("CSV records are too long: {} rows take more than 4 GB", rowCount() + 1);
+
+            offsets.push_back(static_cast<uint32_t>(offset));
+            lengths.push_back(static_cast<uint32_t>(field.size()));
+        }
+
+        void finishRecord()
+        {
+            const auto recordStart = recordEnds.empty() ? 0 : recordEnds.back();
+            columnCount = std::max(columnCount, offsets.size() - recordStart);
+            recordEnds.push_back(offsets.size());
+        }
+
+        CsvFieldTile finish() const
+        {
+            CsvFieldTile tile;
+            tile.base = base;
+            tile.rowCount = rowCount();
+            tile.columnCount = columnCount;
+            tile.offsets.assign(tile.rowCount * tile.columnCount, 0);
+            tile.lengths.assign(tile.rowCount * tile.columnCount, CsvFieldTile::missing);
+
+            size_t fieldIndex = 0;
+            for(size_t row = 0; row < tile.rowCount; row++)
+            {
+                for(size_t column = 0; fieldIndex < recordEnds[row]; column++, fieldIndex++)
+                {
+                    tile.offsets[column * tile.rowCount + row] = offsets[fieldIndex];
+                    tile.lengths[column * tile.rowCount + row] = lengths[fieldIndex];
+                }
+            }
+            return tile;
+        }
+    };
+}
+
+std::vector<CsvFieldTile> CsvParser::parseCsvTiles(size_t rowsPerTile /*= CsvFieldTile::defaultRowCount*/, LoadProgress *progress /*= nullptr*/)
+{
+    std::vector<CsvFieldTile> tiles;
+
+    auto reportedPosition = bufferIterator;
+    const auto reportTile = [&] (const CsvFieldTile &tile)
+    {
+        if(!progress)
+            return;
+
+        progress->bytesRead += bufferIterator - reportedPosition;
+        progress->rowsParsed += tile.rowCount;
+        reportedPosition = bufferIterator;
+        progress->throwIfCancelled();
+    };
+
+    CsvTileBuilder builder;
+    builder.start(bufferIterator);
+    while(bufferIterator < bufferEnd)
+    {
+        parseRecordFields([&] (std::string_view field) { builder.addField(field); });
+        builder.finishRecord();
+
+        if(builder.rowCount() >= rowsPerTile)
+        {
+            reportTile(tiles.emplace_back(builder.finish()));
+            builder.start(bufferIterator);
+        }
+    }
+
+    if(builder.rowCount())
+        reportTile(tiles.emplace_back(builder.finish()));
+
+    return tiles;
+}
+
+CsvStreamReader::CsvStreamReader(std::string_view filePath, CsvReadOptions options, int64_t batchRowCount, size_t blockSize /*= 1 << 20*/)
+    : input(filePath)
+    , options(std::move(options))
+    , batchRowCount(batchRowCount)
+    , blockSize(blockSize)
+{
+    if(batchRowCount <= 0)
+        THROW("batch row count must be positive, got {}", batchRowCount);
+    if(blockSize == 0)
+        THROW("block size must be positive");
+
+    // The first batch is read eagerly, as its records are needed to establish the schema.
+    const size_t startRow = holds_alternative<TakeFirstRowAsHeaders>(this->options.header) ? 1 : 0;
+    gatherRecords(startRow + batchRowCount);
+
+    std::vector<ParsedCsv::Chunk> chunks;
+    chunks.push_back(parseGatheredRecords());
+    const auto &tiles = chunks.front();
+
+    size_t fieldCount = 0;
+    for(auto &tile : tiles)
+        fieldCount = std::max(fieldCount, tile.columnCount);
+
+    const auto names = decideColumnNames((int)fieldCount, this->options.header, [&] (int column)
+    {
+        const auto &headerTile = tiles.front();
+        if(headerTile.hasField(column, 0))
+            return std::string(headerTile.field(column, 0));
+        else
+            return ""s;
+    });
+
+    selectedColumns = selectColumnIndices(this->options.columns, names);
+    const auto columnType = [&] (int column)
+    {
+        if(column < this->options.columnTypes.size())
+            return this->options.columnTypes[column];
+        return deduceType(chunks, column, startRow, this->options.typeDeductionDepth);
+    };
+    columnTypes = transformToVector(selectedColumns, columnType);
+    if(this->options.predicate.size())
+        rowFilter = std::make_shared<CsvRowFilter>(this->options.predicate.c_str(), names, columnType);
+
+    // Later batches may contain missing values even if the first one did not.
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    for(size_t i = 0; i < selectedColumns.size(); i++)
+    {
+        const auto &typeInfo = columnTypes.at(i);
+        fields.push_back(std::make_shared<arrow::Field>(names.at(selectedColumns[i]), typeInfo.type, typeInfo.nullable || typeInfo.deduced));
+    }
+    schema_ = std::make_shared<arrow::Schema>(fields);
+
+    if(rowCount(tiles) > startRow)
+        firstBatch = makeBatch(tiles, startRow);
+    if(firstBatch && firstBatch->num_rows() == 0)
+        firstBatch = nullptr; // all rows were filtered out
+    discardGatheredRecords();
+}
+
+std::shared_ptr<arrow::Schema> CsvStreamReader::schema() const
+{
+    return schema_;
+}
+
+std::shared_ptr<arrow::RecordBatch> CsvStreamReader::readNext()
+{
+    if(firstBatch)
+        return std::exchange(firstBatch, nullptr);
+
+    // with predicate, there might be batches with all records filtered out -- these are skipped
+    while(true)
+    {
+        gatherRecords(batchRowCount);
+        const auto tiles = parseGatheredRecords();
+        auto batch = tiles.empty() ? nullptr : makeBatch(tiles, 0);
+        discardGatheredRecords();
+        if(!batch || batch->num_rows() > 0)
+            return batch;
+    }
+}
+
+void CsvStreamReader::readBlock()
+{
+    const auto oldSize = pending.size();
+    pending.resize(oldSize + blockSize);
+    const auto readCount = input.read(&pending[oldSize], blockSize);
+    pending.resize(oldSize + readCount);
+
+    if(readCount < blockSize)
+        reachedEnd = true;
+}
+
+void CsvStreamReader::gatherRecords(size_t count)
+{
+    while(foundRecordCount < count)
+    {
+        const auto dataEnd = pending.data() + pending.size();
+        while(scannedLength < pending.size() && foundRecordCount < count)
+        {
+            const auto separator = findUnquotedSeparator(pending.data() + scannedLength, dataEnd, options.recordSeparator, options.quote, inQuotes);
+            scannedLength = std::distance(pending.data(), separator);
+            if(separator != dataEnd)
+            {
+                ++foundRecordCount;
+                foundRecordsLength = ++scannedLength;
+            }
+        }
+
+        if(foundRecordCount >= count)
+            return;
+
+        if(reachedEnd)
+        {
+            // the last record does not need to be terminated with a separator
+            if(foundRecordsLength < pending.size())
+            {
+                ++foundRecordCount;
+                foundRecordsLength = pending.size();
+            }
+            return;
+        }
+
+        readBlock();
+    }
+}
+
+std::vector<CsvFieldTile> CsvStreamReader::parseGatheredRecords()
+{
+    const auto start = pending.data();
+    CsvParser parser{start, start + foundRecordsLength, options.fieldSeparator, options.recordSeparator, options.quote};
+    return parser.parseCsvTiles();
+}
+
+void CsvStreamReader::discardGatheredRecords()
+{
+    pending.erase(0, foundRecordsLength);
+    scannedLength -= foundRecordsLength;
+    foundRecordsLength = 0;
+    foundRecordCount = 0;
+}
+
+std::shared_ptr<arrow::RecordBatch> CsvStreamReader::makeBatch(const std::vector<CsvFieldTile> &tiles, size_t startRow) const
+{
+    const auto rowMask = rowFilter ? rowFilter->evaluate(tiles, startRow) : nullptr;
+    const auto rowMaskData = rowMask ? rowMask->data() : nullptr;
+    const auto arrays = buildCsvArrays(tiles, startRow, selectedColumns, columnTypes, rowMaskData);
+    return arrow::RecordBatch::Make(schema_, selectedRowCount(tiles, startRow, rowMaskData), arrays);
+}
+
 std::shared_ptr<arrow::Table> FormatCSV::readString(std::string data, const CsvReadOptions &options) const
 {
-    auto csv = parseCsvData(std::move(data), options.fieldSeparator, options.recordSeparator, options.quote);
-    return csvToArrowTable(csv, options.header, options.columnTypes, options.typeDeductionDepth);
+    auto csv = parseCsvData(std::move(data), options.fieldSeparator, options.recordSeparator, options.quote, options.threadCount, options.progress);
+    return csvToArrowTable(csv, options.header, options.columnTypes, options.typeDeductionDepth, options.threadCount, options.columns, options.predicate.size() ? options.predicate.c_str() : nullptr, options.dictionaryEncoding);
 }
 
 std::string FormatCSV::writeToString(const arrow::Table &table, const CsvWriteOptions &options) const
 {
     std::ostringstream out;
-    generateCsv(out, table, options.headerPolicy, options.quotingPolicy, options.fieldSeparator, options.recordSeparator, options.quote);
+    generateCsv(out, table, options.headerPolicy, options.quotingPolicy, options.fieldSeparator, options.recordSeparator, options.quote, options.threadCount);
     return out.str();
 }
 
@@ -601,14 +1312,36 @@ std::string FormatCSV::fileSignature() const
 
 std::shared_ptr<arrow::Table> FormatCSV::read(std::string_view filePath, const CsvReadOptions &options) const
 {
-    auto buffer = getFileContents(filePath);
-    return readString(std::move(buffer), options);
+    if(const auto cache = CsvCache::active())
+        return cache->read(filePath, options);
+
+    return readUncached(filePath, options);
+}
+
+std::shared_ptr<arrow::Table> FormatCSV::readUncached(std::string_view filePath, const CsvReadOptions &options) const
+{
+    const auto compression = options.compression ? *options.compression : detectCompression(filePath);
+    const auto compressed = compression != Compression::None;
+    if(options.progress && !compressed)
+        options.progress->bytesTotal = (int64_t)boost::filesystem::file_size(std::string(filePath));
+    if(!compressed && !options.memoryMapping)
+        return readString(getFileContents(filePath), options);
+
+    auto csv = compressed
+        ? parseCompressedCsvFile(filePath, options.fieldSeparator, options.recordSeparator, options.quote, options.threadCount, 16 << 20, options.progress, compression)
+        : parseCsvFile(filePath, options.fieldSeparator, options.recordSeparator, options.quote, options.threadCount, options.progress);
+    return csvToArrowTable(csv, options.header, options.columnTypes, options.typeDeductionDepth, options.threadCount, options.columns, options.predicate.size() ? options.predicate.c_str() : nullptr, options.dictionaryEncoding);
 }
 
 void FormatCSV::write(std::string_view filePath, const arrow::Table &table, const CsvWriteOptions &options) const
 {
     auto out = openFileToWrite(filePath);
-    generateCsv(out, table, options.headerPolicy, options.quotingPolicy, options.fieldSeparator, options.recordSeparator, options.quote);
+    generateCsv(out, table, options.headerPolicy, options.quotingPolicy, options.fieldSeparator, options.recordSeparator, options.quote, options.threadCount);
+}
+
+bool FormatCSV::readsCompressedFiles() const
+{
+    return true;
 }
 
 std::vector<std::string> FormatCSV::fileExtensions() const
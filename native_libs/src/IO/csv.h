@@ -2,37 +2,77 @@
 
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <limits>
 #include <memory>
 #include <ostream>
+#include <string>
 #include <string_view>
 #include <vector>
 
 #include <arrow/type.h>
 
 #include "Core/Common.h"
+#include "Compression.h"
 #include "IO.h"
 
 namespace arrow
 {
+    class RecordBatch;
+    class Schema;
     class Table;
 }
 
+class CsvRowFilter;
+struct LoadProgress;
+
 
 DFH_EXPORT arrow::Type::type deduceType(std::string_view text);
 
+// Whether string columns are read as dictionary-encoded, i.e. as integer codes into an array of their distinct values.
+enum class DictionaryEncoding : int8_t
+{
+    Never,
+    Automatic, // encodes columns where type deduction sample has few distinct values
+    Always
+};
+
+// Fields of a tile of consecutive records, kept as 32-bit offsets into the parsed buffer (relative to `base`).
+// Offsets are laid out column-major, so fields of a single column are contiguous.
+struct DFH_EXPORT CsvFieldTile
+{
+    static constexpr uint32_t missing = std::numeric_limits<uint32_t>::max(); // length of fields absent from short records
+    static constexpr uint32_t defaultRowCount = 8192;
+
+    char *base{};
+    size_t rowCount{};
+    size_t columnCount{};
+    std::vector<uint32_t> offsets; // [column * rowCount + row] => field start relative to base
+    std::vector<uint32_t> lengths; // [column * rowCount + row] => field length or `missing`
+
+    bool hasField(size_t column, size_t row) const
+    {
+        return column < columnCount && lengths[column * rowCount + row] != missing;
+    }
+    std::string_view field(size_t column, size_t row) const
+    {
+        const auto index = column * rowCount + row;
+        return { base + offsets[index], lengths[index] };
+    }
+};
+
 struct ParsedCsv
 {
-    using Field = std::string_view;
-    using Record = std::vector<Field>;
-    using Table = std::vector<Record>;
+    using Chunk = std::vector<CsvFieldTile>;
 
-    std::unique_ptr<std::string> buffer; // note: due to SSO we can't keep buffer by value, as we want data memory address to be constant
-    Table records;
+    std::shared_ptr<void> buffer; // owner of the memory that fields refer to: std::string (can't keep by value due to SSO) or MappedFile
+    std::vector<Chunk> chunks; // records of consecutive, independently parsed buffer parts (always at least one)
 
     size_t fieldCount{};
     size_t recordCount{};
 
-    ParsedCsv(std::unique_ptr<std::string> buffer, Table records);
+    ParsedCsv(std::shared_ptr<void> buffer, std::vector<Chunk> chunks);
     ParsedCsv(const ParsedCsv &) = delete;
     ParsedCsv(ParsedCsv &&) = default;
 };
@@ -57,12 +97,31 @@ struct DFH_EXPORT CsvParser
     std::string_view parseField(); // sets buffer Iterator to the next separator
     std::vector<std::string_view> parseRecord();
     std::vector<std::vector<std::string_view>> parseCsvTable();
+    // If `progress` is given, parsed bytes and records are reported to it after each tile and cancellation is polled.
+    std::vector<CsvFieldTile> parseCsvTiles(size_t rowsPerTile = CsvFieldTile::defaultRowCount, LoadProgress *progress = nullptr);
+
+private:
+    template<typename FieldHandler>
+    void parseRecordFields(FieldHandler &&handleField);
 };
 
-DFH_EXPORT ParsedCsv parseCsvData(std::string data, char fieldSeparator = ',', char recordSeparator = '\n', char quote = '"');
-DFH_EXPORT std::shared_ptr<arrow::Table> csvToArrowTable(const ParsedCsv &csv, HeaderPolicy header, std::vector<ColumnType> columnTypes, int typeDeductionDepth);
+// Returns pointers to the beginnings of consecutive buffer parts (and the buffer end as the last element).
+// Each part consists of whole records, so it can be parsed independently of others.
+// Splitting is quote-aware, i.e. record separators within quoted fields are not considered.
+DFH_EXPORT std::vector<char *> findCsvChunkBoundaries(char *bufferStart, char *bufferEnd, int maxChunkCount, char recordSeparator = '\n', char quote = '"');
+
+DFH_EXPORT ParsedCsv parseCsvData(std::string data, char fieldSeparator = ',', char recordSeparator = '\n', char quote = '"', int threadCount = 1, LoadProgress *progress = nullptr);
+DFH_EXPORT ParsedCsv parseCsvFile(std::string_view filePath, char fieldSeparator = ',', char recordSeparator = '\n', char quote = '"', int threadCount = 1, LoadProgress *progress = nullptr); // parses memory-mapped file contents
+// Decompresses gzip or zstd file contents while parsing them. With multiple threads, the contents are cut into segments
+// of whole records (of roughly `segmentSize` bytes), each parsed as a separate chunk while the following ones are decompressed.
+DFH_EXPORT ParsedCsv parseCompressedCsvFile(std::string_view filePath, char fieldSeparator = ',', char recordSeparator = '\n', char quote = '"', int threadCount = 1, size_t segmentSize = 16 << 20, LoadProgress *progress = nullptr, std::optional<Compression> compression = std::nullopt);
+// Column types are given for the columns of the file, `columns` selects which of them should be built (empty means all).
+// If LQuery `predicate` is given, only rows satisfying it are built. It may refer to any column of the file.
+// Dictionary-encoded columns of a chunked table share a single dictionary.
+DFH_EXPORT std::shared_ptr<arrow::Table> csvToArrowTable(const ParsedCsv &csv, HeaderPolicy header, std::vector<ColumnType> columnTypes, int typeDeductionDepth, int threadCount = 1, const std::vector<ColumnSelector> &columns = {}, const char *predicate = nullptr, DictionaryEncoding dictionaryEncoding = DictionaryEncoding::Never);
 
-DFH_EXPORT void generateCsv(std::ostream &out, const arrow::Table &table, GeneratorHeaderPolicy headerPolicy, GeneratorQuotingPolicy quotingPolicy, char fieldSeparator = ',', char recordSeparator = '\n', char quote = '"');
+// Rows are formatted in blocks by `threadCount` threads (0 uses all hardware threads) and written in order.
+DFH_EXPORT void generateCsv(std::ostream &out, const arrow::Table &table, GeneratorHeaderPolicy headerPolicy, GeneratorQuotingPolicy quotingPolicy, char fieldSeparator = ',', char recordSeparator = '\n', char quote = '"', int threadCount = 1);
 
 struct CsvCommonOptions
 {
@@ -74,14 +133,60 @@ struct CsvCommonOptions
 struct CsvReadOptions : CsvCommonOptions
 {
     HeaderPolicy header = TakeFirstRowAsHeaders{};
-    std::vector<ColumnType> columnTypes = {};
+    std::vector<ColumnType> columnTypes = {}; // types of the file columns (not only of the selected ones)
+    std::vector<ColumnSelector> columns = {}; // columns to be read, in the given order; empty means all
+    std::string predicate; // LQuery predicate JSON, only rows satisfying it are read; empty means all
     int typeDeductionDepth = 50;
+    DictionaryEncoding dictionaryEncoding = DictionaryEncoding::Never; // applies only to string columns
+    int threadCount = 1; // values other than 1 make the file parsed in chunks, yielding a chunked table; 0 uses all hardware threads
+    bool memoryMapping = true; // whether the file should be parsed in place in memory-mapped pages rather than in a copy of its contents (ignored for compressed files)
+    LoadProgress *progress = nullptr; // if set, receives parsing progress (in bytes of decompressed text) and is polled for cancellation
+    std::optional<Compression> compression; // of the file, detected from its first bytes if not given
 };
 
 struct CsvWriteOptions : CsvCommonOptions
 {
     GeneratorHeaderPolicy headerPolicy = GeneratorHeaderPolicy::GenerateHeaderLine;
     GeneratorQuotingPolicy quotingPolicy;    
+    int threadCount = 1; // threads formatting the records; 0 uses all hardware threads
+};
+
+// Reads CSV file incrementally, yielding record batches of at most `batchRowCount` rows.
+// File is read in blocks and only the data needed for the current batch is kept in memory.
+// The schema is deduced from the first batch (which is read by constructor) and is kept for all batches.
+// Options related to multi-threading and dictionary encoding are ignored (batches could not share a growing dictionary).
+// Compressed files are decompressed on the fly.
+class DFH_EXPORT CsvStreamReader
+{
+    DecompressingReader input;
+    CsvReadOptions options;
+    int64_t batchRowCount{};
+    size_t blockSize{};
+
+    std::string pending; // data read from file but not yet converted into batches
+    size_t scannedLength = 0; // length of the `pending` prefix already scanned for record ends
+    size_t foundRecordCount = 0; // complete records in the scanned prefix
+    size_t foundRecordsLength = 0; // length of the prefix with found records
+    bool inQuotes = false; // whether the scan position is within a quoted field
+    bool reachedEnd = false; // whether the whole file was read into `pending`
+
+    std::vector<int> selectedColumns; // indices of file columns that make the batch columns
+    std::vector<ColumnType> columnTypes; // types of the selected columns
+    std::shared_ptr<CsvRowFilter> rowFilter; // nullptr if there is no predicate
+    std::shared_ptr<arrow::Schema> schema_;
+    std::shared_ptr<arrow::RecordBatch> firstBatch;
+
+    void readBlock();
+    void gatherRecords(size_t count);
+    std::vector<CsvFieldTile> parseGatheredRecords(); // fields are offsets into `pending`, valid until `discardGatheredRecords` call
+    void discardGatheredRecords();
+    std::shared_ptr<arrow::RecordBatch> makeBatch(const std::vector<CsvFieldTile> &tiles, size_t startRow) const;
+
+public:
+    CsvStreamReader(std::string_view filePath, CsvReadOptions options, int64_t batchRowCount, size_t blockSize = 1 << 20);
+
+    std::shared_ptr<arrow::Schema> schema() const;
+    std::shared_ptr<arrow::RecordBatch> readNext(); // returns nullptr when there are no more records
 };
 
 struct DFH_EXPORT FormatCSV : TableFileHandlerWithOptions<CsvReadOptions, CsvWriteOptions>
@@ -91,9 +196,11 @@ struct DFH_EXPORT FormatCSV : TableFileHandlerWithOptions<CsvReadOptions, CsvWri
 
     std::shared_ptr<arrow::Table> readString(std::string data, const CsvReadOptions &options) const;
     std::string writeToString(const arrow::Table &table, const CsvWriteOptions &options) const;
+    std::shared_ptr<arrow::Table> readUncached(std::string_view filePath, const CsvReadOptions &options) const; // bypasses CsvCache
 
     virtual std::string fileSignature() const override;
-    virtual std::shared_ptr<arrow::Table> read(std::string_view filePath, const CsvReadOptions &options) const override;
+    virtual std::shared_ptr<arrow::Table> read(std::string_view filePath, const CsvReadOptions &options) const override; // served by CsvCache when it is enabled
     virtual void write(std::string_view filePath, const arrow::Table &table, const CsvWriteOptions &options) const override;
     virtual std::vector<std::string> fileExtensions() const override;
+    virtual bool readsCompressedFiles() const override;
 };
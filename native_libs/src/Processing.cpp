@@ -2,6 +2,7 @@
 
 #include <bitset>
 #include <cassert>
+#include <cmath>
 #include <iostream>
 #include <numeric>
 #include <vector>
@@ -18,6 +19,7 @@
 
 #include "Core/ArrowUtilities.h"
 #include "LQuery/AST.h"
+#include "LQuery/Functions.h"
 #include "LQuery/Interpreter.h"
 #include "Analysis.h"
 #include "Sort.h"
@@ -439,7 +441,7 @@ std::shared_ptr<arrow::Array> fillNA(std::shared_ptr<arrow::Array> array, Dynami
     if(array->null_count() == 0)
         return array;
 
-    return visitArray(*array, [&] (auto *array)
+    return visitArray(*decodeDictionary(array), [&] (auto *array)
     {
         return visit([&] (auto value)
         {
@@ -465,6 +467,7 @@ std::shared_ptr<arrow::Column> fillNA(std::shared_ptr<arrow::Column> column, Dyn
     if(column->null_count() == 0)
         return column;
 
+    column = decodeDictionary(column); // filled values might be absent from the dictionary
     auto newField = setNullable(false, column->field());
     auto newChunks = fillNA(column->data(), value);
     return std::make_shared<arrow::Column>(newField, newChunks);
@@ -494,9 +497,174 @@ std::shared_ptr<arrow::Table> fillNA(std::shared_ptr<arrow::Table> table, const
     return arrow::Table::Make(newSchema, newColumns);
 }
 
+namespace
+{
+    using ComparedLiteral = variant<int64_t, double, Timestamp>;
+
+    // Comparison of a column with a literal, with the column on the left side.
+    struct LiteralComparison
+    {
+        ast::PredicateFromValueOperator what; // Greater, Lesser or Equal
+        ColumnReferenceId column;
+        ComparedLiteral literal;
+    };
+
+    std::optional<ComparedLiteral> comparedLiteral(const ast::Value &value)
+    {
+        const auto &base = (const ast::ValueBase &)value;
+        if(auto literal = get_if<ast::Literal<int64_t>>(&base))
+            return literal->literal;
+        if(auto literal = get_if<ast::Literal<double>>(&base))
+            return literal->literal;
+        if(auto literal = get_if<ast::Literal<Timestamp>>(&base))
+            return literal->literal;
+        return std::nullopt;
+    }
+
+    // Gathers comparisons of columns with literals, if the predicate is a conjunction of them.
+    bool collectLiteralComparisons(const ast::Predicate &predicate, std::vector<LiteralComparison> &comparisons)
+    {
+        using Operator = ast::PredicateFromValueOperator;
+
+        const auto &base = (const ast::PredicateBase &)predicate;
+        if(auto operation = get_if<ast::PredicateOperation>(&base))
+        {
+            return operation->what == ast::PredicateOperator::And
+                && operation->operands.size() == 2
+                && collectLiteralComparisons(operation->operands[0], comparisons)
+                && collectLiteralComparisons(operation->operands[1], comparisons);
+        }
+
+        const auto &comparison = get<ast::PredicateFromValueOperation>(base);
+        if(comparison.operands.size() != 2 || (comparison.what != Operator::Greater && comparison.what != Operator::Lesser && comparison.what != Operator::Equal))
+            return false;
+
+        const auto &lhs = comparison.operands[0];
+        const auto &rhs = comparison.operands[1];
+        if(auto column = get_if<ast::ColumnReference>(&(const ast::ValueBase &)lhs))
+        {
+            if(auto literal = comparedLiteral(rhs))
+            {
+                comparisons.push_back(LiteralComparison{ comparison.what, column->columnRefId, *literal });
+                return true;
+            }
+        }
+        if(auto column = get_if<ast::ColumnReference>(&(const ast::ValueBase &)rhs))
+        {
+            if(auto literal = comparedLiteral(lhs))
+            {
+                const auto flipped = comparison.what == Operator::Greater ? Operator::Lesser
+                    : comparison.what == Operator::Lesser ? Operator::Greater
+                    : comparison.what;
+                comparisons.push_back(LiteralComparison{ flipped, column->columnRefId, *literal });
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // If the predicate only compares a single sorted column with literals, rows matching it are a contiguous range
+    // of the table. Returns the range [begin, end), found by binary search over the column.
+    std::optional<std::pair<int64_t, int64_t>> matchingRowRange(const arrow::Table &table, const ast::Predicate &predicate, const ColumnMapping &mapping)
+    {
+        std::vector<LiteralComparison> comparisons;
+        if(!collectLiteralComparisons(predicate, comparisons))
+            return std::nullopt;
+
+        const auto referenceId = comparisons.front().column;
+        for(auto &comparison : comparisons)
+            if(comparison.column != referenceId)
+                return std::nullopt;
+
+        // other types are not compared with literals this way by the interpreter, so it reports their errors
+        const auto column = table.column(mapping.at(referenceId));
+        const auto isTimestamp = column->type()->id() == arrow::Type::TIMESTAMP;
+        if(column->type()->id() != arrow::Type::INT64 && column->type()->id() != arrow::Type::DOUBLE && !isTimestamp)
+            return std::nullopt;
+        for(auto &comparison : comparisons)
+        {
+            if(holds_alternative<Timestamp>(comparison.literal) != isTimestamp)
+                return std::nullopt;
+            // NaN compares neither less, nor greater, nor equal, so it does not split sorted values
+            if(auto literal = get_if<double>(&comparison.literal); literal && std::isnan(*literal))
+                return std::nullopt;
+        }
+
+        const auto order = columnOrder(*column);
+        if(!order.nonDecreasing && !order.nonIncreasing)
+            return std::nullopt;
+
+        // rows with nulls never match
+        int64_t validBegin = 0;
+        int64_t validEnd = column->length();
+        if(column->null_count() != 0)
+        {
+            if(order.nullsFirst)
+                validBegin = column->null_count();
+            else if(order.nullsLast)
+                validEnd -= column->null_count();
+            else
+                return std::nullopt;
+        }
+
+        return visitType(*column->type(), [&] (auto id) -> std::optional<std::pair<int64_t, int64_t>>
+        {
+            if constexpr(id.value == arrow::Type::STRING)
+                return std::nullopt;
+            else
+            {
+                // Each comparison fails either for values that are too low or for ones that are too high.
+                const ChunkAccessor chunks{ *column };
+                const auto failsAs = [&] (int64_t row, bool tooLow)
+                {
+                    const auto value = chunks.valueAt<id.value>(row);
+                    for(auto &comparison : comparisons)
+                    {
+                        const auto failed = visit([&] (auto literal)
+                        {
+                            switch(comparison.what)
+                            {
+                            case ast::PredicateFromValueOperator::Greater: return tooLow && !GreaterThan::exec(value, literal);
+                            case ast::PredicateFromValueOperator::Lesser:  return !tooLow && !LessThan::exec(value, literal);
+                            default: return tooLow ? LessThan::exec(value, literal) : GreaterThan::exec(value, literal);
+                            }
+                        }, comparison.literal);
+                        if(failed)
+                            return true;
+                    }
+                    return false;
+                };
+
+                // first row in [begin, end) for which monotonic `predicate` holds
+                const auto firstRowWhere = [] (int64_t begin, int64_t end, auto &&predicate)
+                {
+                    while(begin < end)
+                    {
+                        const auto middle = begin + (end - begin) / 2;
+                        if(predicate(middle))
+                            end = middle;
+                        else
+                            begin = middle + 1;
+                    }
+                    return begin;
+                };
+
+                // In ascending columns too low values come first, in descending ones too high values do.
+                const auto ascending = order.nonDecreasing;
+                const auto begin = firstRowWhere(validBegin, validEnd, [&] (int64_t row) { return !failsAs(row, ascending); });
+                const auto end = firstRowWhere(begin, validEnd, [&] (int64_t row) { return failsAs(row, !ascending); });
+                return std::make_pair(begin, end);
+            }
+        });
+    }
+}
+
 std::shared_ptr<arrow::Table> filter(std::shared_ptr<arrow::Table> table, const char *dslJsonText)
 {
     auto [mapping, predicate] = ast::parsePredicate(*table, dslJsonText);
+    if(const auto range = matchingRowRange(*table, predicate, mapping))
+        return slice(table, range->first, range->second - range->first);
+
     const auto maskBuffer = execute(*table, predicate, mapping);
     return filter(table, *maskBuffer);
 }
@@ -515,6 +683,18 @@ std::shared_ptr<arrow::Table> filter(std::shared_ptr<arrow::Table> table, const
     for(int columnIndex = 0; columnIndex < table->num_columns(); columnIndex++)
     {
         const auto column = table->column(columnIndex);
+        if(column->type()->id() == arrow::Type::DICTIONARY)
+        {
+            // only codes need to be filtered, the dictionary stays the same
+            const auto indices = dictionaryIndices(*column);
+            const auto filteredIndices = visitIndexType(*indices->type(), [&] (auto id)
+            {
+                return FilteredArrayBuilder<id.value>::makeFiltered(maskData, newRowCount, *indices);
+            });
+            newColumns.push_back(withDictionaryIndices(column->field(), *filteredIndices));
+            continue;
+        }
+
         const auto filteredColumn = visitType(*column->type(), [&] (auto id) -> std::shared_ptr<arrow::Column>
         {
             return FilteredArrayBuilder<id.value>::makeFiltered(maskData, newRowCount, *column);
@@ -662,14 +842,15 @@ DFH_EXPORT std::shared_ptr<arrow::Table> groupBy(std::shared_ptr<arrow::Table> t
 
         // first prepare key column
         {
-            auto builder = makeBuilder(std::static_pointer_cast<TypeT>(keyColumn->type()));
+            auto builder = makeBuilder(std::static_pointer_cast<TypeT>(valueType(keyColumn->type())));
             if(nullRows.size() > 0)
                 builder->AppendNull();
             for(auto &&[keyValue, rows] : keyToRows)
                 append(*builder, keyValue);
 
             const auto arr = finish(*builder);
-            newColumns.push_back(std::make_shared<arrow::Column>(keyColumn->field(), arr));
+            const auto keyField = arrow::field(keyColumn->name(), arr->type(), keyColumn->field()->nullable()); // dictionary-encoded keys are decoded
+            newColumns.push_back(std::make_shared<arrow::Column>(keyField, arr));
         }
 
         for(auto column : getColumns(*table))
@@ -677,7 +858,7 @@ DFH_EXPORT std::shared_ptr<arrow::Table> groupBy(std::shared_ptr<arrow::Table> t
             if(column == keyColumn)
                 continue;
 
-            visitType(column->type()->id(), [&](auto colType)
+            visitType(*column->type(), [&](auto colType)
             {
                 const auto listType = std::make_shared<arrow::ListType>(column->field());
 
@@ -693,7 +874,7 @@ DFH_EXPORT std::shared_ptr<arrow::Table> groupBy(std::shared_ptr<arrow::Table> t
 
 std::shared_ptr<arrow::Column> splitOn(const arrow::Column &column, std::string_view separator)
 {
-    if(column.type()->id() != arrow::Type::STRING)
+    if(valueType(column.type())->id() != arrow::Type::STRING)
         THROW("cannot split on column `{}` of type `{}`: type string required", column.name(), column.type()->ToString());
 
     auto stringBuilder = std::make_shared<arrow::StringBuilder>();
@@ -775,7 +956,7 @@ std::shared_ptr<arrow::Column> ungroup(const arrow::Column &data, const arrow::C
 {
     return visitType(*data.type(), [&](auto id)
     {
-        Ungrouper<id.value> ungrouper{ data.type() };
+        Ungrouper<id.value> ungrouper{ valueType(data.type()) };
         iterateOverPairs<id.value, arrow::Type::LIST>(*data.data(), *listColumn.data(), ungrouper);
         auto arr = ungrouper.finish();
         return toColumn(arr, data.name());
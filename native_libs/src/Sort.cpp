@@ -1,7 +1,17 @@
 #include "Sort.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <mutex>
 #include <numeric>
+#include <unordered_map>
+#include <utility>
 #include "Core/ArrowUtilities.h"
+#include "Core/Parallel.h"
+#include "Processing.h"
 
 template<typename F>
 auto dispatch(SortOrder order, F &&f)
@@ -34,31 +44,32 @@ struct ColumnPermuter
 
     std::shared_ptr<arrow::Column> column;
     std::shared_ptr<ArrowType> type;
-    Permutation indices;
+    const int64_t *indices; // gathers values at `length` indices
+    int64_t length;
 
-    ColumnPermuter(std::shared_ptr<arrow::Column> column, std::shared_ptr<ArrowType> type, Permutation indices, std::bool_constant<nullable> n={})
+    ColumnPermuter(std::shared_ptr<arrow::Column> column, std::shared_ptr<ArrowType> type, const int64_t *indices, int64_t length, std::bool_constant<nullable> n={})
         : column(std::move(column))
         , type(std::move(type))
-        , indices(std::move(indices))
+        , indices(indices)
+        , length(length)
     {}
 
     std::shared_ptr<arrow::Array> operator()() const
     {
-        if(column->length() > std::numeric_limits<int32_t>::max())
+        if(length > std::numeric_limits<int32_t>::max())
             throw std::runtime_error("not implemented: too big array");
 
         using T = typename TypeDescription<ArrowType::type_id>::StorageValueType;
 
-        const auto length = (int32_t)column->length();
-
         const ChunkAccessor chunks{ *column->data() };
-        if constexpr(!nullable && (id == arrow::Type::INT64 || id == arrow::Type::DOUBLE))
+        if constexpr(!nullable && (id == arrow::Type::INT64 || id == arrow::Type::DOUBLE || id == arrow::Type::INT32))
         {
-            FixedSizeArrayBuilder<id, nullable> b{ type, length };
+            FixedSizeArrayBuilder<id, nullable> b{ type, (int32_t)length };
             {
                 T * __restrict target = b.nextValueToWrite;
-                for(auto index : indices)
+                for(int64_t i = 0; i < length; i++)
                 {
+                    const auto index = indices[i];
                     const auto[chunk, indexInChunk] = chunks.locate(index);
                     const auto value = arrayValueAt<id>(*chunk, indexInChunk);
                     // unfortunately gives performance edge over b.Append(value)
@@ -71,9 +82,10 @@ struct ColumnPermuter
         else
         {
             auto b = makeBuilder(type);
-            b->Reserve(indices.size());
-            for(auto index : indices)
+            b->Reserve(length);
+            for(int64_t i = 0; i < length; i++)
             {
+                const auto index = indices[i];
                 const auto[chunk, indexInChunk] = chunks.locate(index);
                 if constexpr(nullable)
                 {
@@ -96,28 +108,77 @@ struct ColumnPermuter
 
 
 
-std::shared_ptr<arrow::Array> permuteInnerToArray(std::shared_ptr<arrow::Column> column, const Permutation &indices)
+// Gathers values of the column at given indices into a single array.
+std::shared_ptr<arrow::Array> permuteInnerToArray(std::shared_ptr<arrow::Column> column, const int64_t *indices, int64_t length)
 {
+    if(column->type()->id() == arrow::Type::DICTIONARY)
+    {
+        // only codes are permuted, the dictionary is shared with the result
+        const auto codes = dictionaryIndices(*column);
+        const auto permutedCodes = visitIndexType(*codes->type(), [&](auto id)
+        {
+            using ArrowType = typename TypeDescription<id.value>::ArrowType;
+            const auto codeType = std::static_pointer_cast<ArrowType>(codes->type());
+            return dispatch(codes->null_count() != 0, [&](auto nullable)
+            {
+                return ColumnPermuter<ArrowType, nullable.value>(codes, codeType, indices, length)();
+            });
+        });
+        return std::make_shared<arrow::DictionaryArray>(column->type(), permutedCodes);
+    }
+
     return visitDataType3(column->type(), [&](auto &&datatype)
     {
         return dispatch(column->null_count() != 0, [&](auto nullable)
         {
             using ArrowType = typename std::decay_t<decltype(datatype)>::element_type;
-            return ColumnPermuter<ArrowType, nullable.value>(column, datatype, indices)();
+            return ColumnPermuter<ArrowType, nullable.value>(column, datatype, indices, length)();
         });
     });
 }
 
+std::shared_ptr<arrow::Array> permuteInnerToArray(std::shared_ptr<arrow::Column> column, const Permutation &indices)
+{
+    return permuteInnerToArray(std::move(column), indices.data(), indices.size());
+}
+
+// Parts shorter than this are not worth a thread of their own.
+constexpr int64_t parallelPermuteMinimumPartLength = 1 << 16;
+
+// Permutes columns concurrently, using the default thread count. Columns are split into parts, becoming chunks
+// of the results, only if there are fewer of them than threads.
+std::vector<std::shared_ptr<arrow::Column>> permuteInner(const std::vector<std::shared_ptr<arrow::Column>> &columns, const Permutation &indices)
+{
+    const auto threadCount = resolveThreadCount(defaultThreadCount());
+    const auto length = (int64_t)indices.size();
+    const auto columnCount = std::max<int64_t>(columns.size(), 1);
+    const auto partsPerColumn = (threadCount + columnCount - 1) / columnCount;
+    const auto partCount = std::clamp<int64_t>(length / parallelPermuteMinimumPartLength, 1, partsPerColumn);
+
+    std::vector<arrow::ArrayVector> parts(columns.size(), arrow::ArrayVector(partCount));
+    parallelFor(columns.size() * partCount, threadCount, [&] (int64_t task)
+    {
+        const auto column = task / partCount;
+        const auto part = task % partCount;
+        const auto partStart = length * part / partCount;
+        const auto partEnd = length * (part + 1) / partCount;
+        parts[column][part] = permuteInnerToArray(columns[column], indices.data() + partStart, partEnd - partStart);
+    });
+
+    std::vector<std::shared_ptr<arrow::Column>> ret;
+    for(size_t i = 0; i < columns.size(); i++)
+        ret.push_back(std::make_shared<arrow::Column>(columns[i]->field(), parts[i]));
+    return ret;
+}
+
 std::shared_ptr<arrow::Column> permuteInner(std::shared_ptr<arrow::Column> column, const Permutation &indices)
 {
-    return std::make_shared<arrow::Column>(column->field(), permuteInnerToArray(column, indices));
+    return permuteInner(std::vector{ column }, indices).front();
 }
 
 std::shared_ptr<arrow::Table> permuteInner(std::shared_ptr<arrow::Table> table, const Permutation &indices)
 {
-    auto oldColumns = getColumns(*table);
-    auto newColumns = transformToVector(oldColumns, [&](auto &&col) { return permuteInner(col, indices); });
-    return arrow::Table::Make(table->schema(), newColumns);
+    return arrow::Table::Make(table->schema(), permuteInner(getColumns(*table), indices));
 }
 
 bool isPermuteId(const Permutation &indices)
@@ -128,22 +189,30 @@ bool isPermuteId(const Permutation &indices)
     return true;
 }
 
-template<arrow::Type::type id, bool nullable, SortOrder order, NullPosition nulls>
-void sortPermutationInner(Permutation &indices, const arrow::Column &sortBy)
+// Order of values used by all sorts, consistent with their radix keys: NaN is greater than any other double
+// and equal to other NaNs, whatever their sign bit and payload.
+template<typename T>
+bool valueLess(const T &lhs, const T &rhs)
 {
-    // Note: Measures shown that it is usually much faster to copy data into vector
-    // rather than keep it in array and each time lookup index for the given chunk.
-    //
-    // For now this is simple and fast enough.
-    using ElementType = typename TypeDescription<id>::ObservedType;
-    using ActualObservedType = std::conditional_t<nullable, std::optional<ElementType>, ElementType>;
+    if constexpr(std::is_floating_point_v<T>)
+        return std::isnan(rhs) ? !std::isnan(lhs) : lhs < rhs;
+    else
+        return lhs < rhs;
+}
+
+// Stable sorts indices by the values (optionals if column is nullable) they refer to.
+template<SortOrder order, NullPosition nulls, typename ActualObservedType>
+void sortPermutationByValues(Permutation &indices, const std::vector<ActualObservedType> &valuesAsVector)
+{
+    constexpr bool nullable = is_optional_v<ActualObservedType>;
+    using ElementType = strip_optional_t<ActualObservedType>;
 
     const auto compareRawValues = [](ElementType lhs, ElementType rhs)
     {
         if constexpr(order == SortOrder::Ascending)
-            return lhs < rhs;
+            return valueLess(lhs, rhs);
         else
-            return lhs > rhs;
+            return valueLess(rhs, lhs);
     };
 
     const auto compareValues = [=](auto &&lhs, auto &&rhs)
@@ -170,9 +239,6 @@ void sortPermutationInner(Permutation &indices, const arrow::Column &sortBy)
         }
     };
 
-    // TODO: special faster path (no-copy) can be provided for single chunk columns
-    // however gains will rather be limited, as sorting and permuting data dominates
-    const auto valuesAsVector = toVector<ActualObservedType>(sortBy);
     std::stable_sort(indices.begin(), indices.end(), [&](int64_t lhsIndex, int64_t rhsIndex)
     {
         const auto &lhs = valuesAsVector[lhsIndex];
@@ -181,6 +247,196 @@ void sortPermutationInner(Permutation &indices, const arrow::Column &sortBy)
     });
 }
 
+// Columns shorter than this are sorted by comparisons, as radix sort has a constant cost of its passes.
+constexpr int64_t radixSortMinimumLength = 1024;
+
+// Maps values to unsigned keys of the same order.
+uint64_t radixKey(int64_t value)
+{
+    return (uint64_t)value ^ (uint64_t(1) << 63);
+}
+uint64_t radixKey(double value)
+{
+    // negative values have their order reversed by flipping all bits, positive ones are moved above them
+    // (-0.0 is mapped as 0.0, as they compare equal); all NaNs get the greatest key, above +inf (see `valueLess`)
+    constexpr auto signBit = uint64_t(1) << 63;
+    if(std::isnan(value))
+        return ~uint64_t(0);
+    const double normalized = value == 0 ? 0.0 : value;
+    uint64_t bits;
+    std::memcpy(&bits, &normalized, sizeof(bits));
+    return (bits & signBit) ? ~bits : bits | signBit;
+}
+uint64_t radixKey(Timestamp value)
+{
+    return radixKey(value.toStorage());
+}
+
+struct KeyedRow
+{
+    uint64_t key;
+    int64_t row;
+};
+
+// Stable LSD radix sort by 11-bit key digits (so at most 6 passes, with histograms small enough to stay in cache).
+// Passes over digits that are the same in all keys (e.g. high bits of timestamps from a limited period) are skipped.
+void radixSort(std::vector<KeyedRow> &rows)
+{
+    constexpr int digitBits = 11;
+    constexpr int bucketCount = 1 << digitBits;
+    constexpr int digitCount = (64 + digitBits - 1) / digitBits;
+    const auto digitOf = [] (uint64_t key, int digit) { return (key >> (digitBits * digit)) & (bucketCount - 1); };
+
+    std::vector<std::array<int64_t, bucketCount>> histograms(digitCount);
+    for(auto &row : rows)
+        for(int digit = 0; digit < digitCount; digit++)
+            histograms[digit][digitOf(row.key, digit)]++;
+
+    std::vector<KeyedRow> buffer(rows.size());
+    for(int digit = 0; digit < digitCount; digit++)
+    {
+        auto &histogram = histograms[digit];
+        if(std::find(histogram.begin(), histogram.end(), (int64_t)rows.size()) != histogram.end())
+            continue;
+
+        // turn counts into starting positions of the buckets
+        int64_t position = 0;
+        for(auto &count : histogram)
+            position += std::exchange(count, position);
+
+        for(auto &row : rows)
+            buffer[histogram[digitOf(row.key, digit)]++] = row;
+        rows.swap(buffer);
+    }
+}
+
+// Stable sorts indices like `sortPermutationByValues`, but by radix sorting (key, index) pairs.
+template<arrow::Type::type id, bool nullable, SortOrder order, NullPosition nulls>
+void radixSortPermutation(Permutation &indices, const arrow::Column &sortBy)
+{
+    // Keys are gathered in row order first, as reading chunks sequentially is much faster than locating rows in
+    // the permutation order.
+    std::vector<uint64_t> rowKeys;
+    std::vector<bool> rowValid;
+    rowKeys.reserve(sortBy.length());
+    if(nullable)
+        rowValid.reserve(sortBy.length());
+
+    iterateOver<id>(sortBy, [&] (auto value)
+    {
+        const auto key = radixKey(value);
+        rowKeys.push_back(order == SortOrder::Ascending ? key : ~key);
+        if(nullable)
+            rowValid.push_back(true);
+    },
+    [&]
+    {
+        rowKeys.push_back(0);
+        rowValid.push_back(false);
+    });
+
+    // nulls keep their current order, before or after all the values
+    auto valuesBegin = indices.begin();
+    auto valuesEnd = indices.end();
+    if constexpr(nullable)
+    {
+        if constexpr(nulls == NullPosition::Before)
+            valuesBegin = std::stable_partition(indices.begin(), indices.end(), [&] (int64_t row) { return !rowValid[row]; });
+        else
+            valuesEnd = std::stable_partition(indices.begin(), indices.end(), [&] (int64_t row) { return (bool)rowValid[row]; });
+    }
+
+    std::vector<KeyedRow> keyedRows;
+    keyedRows.reserve(valuesEnd - valuesBegin);
+    for(auto itr = valuesBegin; itr != valuesEnd; ++itr)
+        keyedRows.push_back(KeyedRow{ rowKeys[*itr], *itr });
+    std::vector<uint64_t>{}.swap(rowKeys); // not needed anymore, memory is better given to the sort buffer
+
+    radixSort(keyedRows);
+    std::transform(keyedRows.begin(), keyedRows.end(), valuesBegin, [] (const KeyedRow &keyedRow) { return keyedRow.row; });
+}
+
+template<arrow::Type::type id, bool nullable, SortOrder order, NullPosition nulls>
+void sortPermutationInner(Permutation &indices, const arrow::Column &sortBy)
+{
+    if constexpr(id == arrow::Type::INT64 || id == arrow::Type::DOUBLE || id == arrow::Type::TIMESTAMP)
+    {
+        if(sortBy.length() >= radixSortMinimumLength)
+            return radixSortPermutation<id, nullable, order, nulls>(indices, sortBy);
+    }
+
+    // Note: Measures shown that it is usually much faster to copy data into vector
+    // rather than keep it in array and each time lookup index for the given chunk.
+    //
+    // For now this is simple and fast enough.
+    using ElementType = typename TypeDescription<id>::ObservedType;
+    using ActualObservedType = std::conditional_t<nullable, std::optional<ElementType>, ElementType>;
+
+    // TODO: special faster path (no-copy) can be provided for single chunk columns
+    // however gains will rather be limited, as sorting and permuting data dominates
+    const auto valuesAsVector = toVector<ActualObservedType>(sortBy);
+    sortPermutationByValues<order, nulls>(indices, valuesAsVector);
+}
+
+// Returns ranks of dictionary values (their positions among distinct values of the sorted dictionary), indexed by codes.
+// Equal values get equal ranks, as dictionaries are not guaranteed to be unique (e.g. when unified from chunks).
+std::vector<int32_t> dictionaryRanks(const arrow::Column &column)
+{
+    const auto dictionary = static_cast<const arrow::DictionaryType &>(*column.type()).dictionary();
+    return visitType(*dictionary->type(), [&] (auto id)
+    {
+        using ElementType = typename TypeDescription<id.value>::ObservedType;
+        const auto values = toVector<ElementType>(*dictionary);
+        auto codesByValue = iotaVector<int32_t>(values.size());
+        std::sort(codesByValue.begin(), codesByValue.end(), [&](int32_t lhs, int32_t rhs) { return values[lhs] < values[rhs]; });
+
+        std::vector<int32_t> ranks(values.size()); // [code] => rank
+        int32_t rank = 0;
+        for(int32_t i = 0; i < (int32_t)codesByValue.size(); i++)
+        {
+            if(i && values[codesByValue[i - 1]] < values[codesByValue[i]])
+                rank++;
+            ranks[codesByValue[i]] = rank;
+        }
+        return ranks;
+    });
+}
+
+// Calls handleRank with the rank of each row's value (see `dictionaryRanks`) or handleNull for null rows.
+template<typename RankF, typename NullF>
+void iterateOverRanks(const arrow::Column &column, const std::vector<int32_t> &ranks, RankF &&handleRank, NullF &&handleNull)
+{
+    for(auto &chunk : column.data()->chunks())
+    {
+        const auto &array = static_cast<const arrow::DictionaryArray &>(*chunk);
+        const auto hasNulls = array.null_count() != 0;
+        visitDictionaryCodes(array, [&] (auto *codes)
+        {
+            for(int64_t row = 0; row < array.length(); row++)
+            {
+                if(hasNulls && array.IsNull(row))
+                    handleNull();
+                else
+                    handleRank(ranks[codes[row]]);
+            }
+        });
+    }
+}
+
+// Dictionary-encoded column is sorted by its codes: only the dictionary values are compared,
+// then each row is represented by the rank of its value within the dictionary.
+template<bool nullable, SortOrder order, NullPosition nulls>
+void sortPermutationByCodes(Permutation &indices, const arrow::Column &sortBy)
+{
+    const auto ranks = dictionaryRanks(sortBy);
+
+    using Rank = std::conditional_t<nullable, std::optional<int32_t>, int32_t>;
+    std::vector<Rank> rowRanks;
+    rowRanks.reserve(sortBy.length());
+    iterateOverRanks(sortBy, ranks, [&] (int32_t rank) { rowRanks.push_back(rank); }, [&] { rowRanks.push_back(Rank{}); });
+    sortPermutationByValues<order, nulls>(indices, rowRanks);
+}
+
 void sortPermutation(Permutation &indices, const arrow::Column &sortBy, SortOrder order, NullPosition nullPosition)
 {
     // Hoist runtime constant values to the compile-time values.
@@ -192,17 +448,249 @@ void sortPermutation(Permutation &indices, const arrow::Column &sortBy, SortOrde
             {
                 dispatch(sortBy.null_count() != 0, [&] (auto hasNullsC)
                 {
-                    sortPermutationInner<id.value, hasNullsC.value, orderC.value, nullPosition.value>(indices, sortBy);
+                    if(sortBy.type()->id() == arrow::Type::DICTIONARY)
+                        sortPermutationByCodes<hasNullsC.value, orderC.value, nullPosition.value>(indices, sortBy);
+                    else
+                        sortPermutationInner<id.value, hasNullsC.value, orderC.value, nullPosition.value>(indices, sortBy);
                 });
             });
         });
     });
 }
 
-std::vector<int64_t> sortPermutation(std::vector<SortBy> sortBy)
+// Normalized keys: sort keys of each row encoded into a fixed-width byte string, such that comparing the strings
+// bytewise orders rows as comparing their keys one after another would. Each key takes a null flag byte (if its
+// column has nulls) and its value bytes: big-endian radix keys of numbers, ranks of dictionary codes, or prefixes
+// of strings. Descending keys have their value bytes complemented.
+//
+// Only `exactKeyCount` leading keys are fully encoded: encoding stops after a string prefix (as longer strings can
+// tie on it) or before a key that would exceed the maximum width. Rows with equal normalized keys need comparing by
+// the keys from `exactKeyCount` onwards, unless all keys are exact.
+//
+// Keys are stored in records that are followed by the row index, so sorting can move whole records.
+struct NormalizedKeys
 {
-    if(sortBy.empty())
-        throw std::runtime_error("no column to sort by");
+    static constexpr size_t maxWidth = 32;
+    static constexpr size_t stringPrefixLength = 8;
+
+    size_t width = 0; // bytes of the encoded keys
+    size_t exactKeyCount = 0;
+    std::vector<uint8_t> records; // [row * recordSize()] => keys, followed by int64_t row index
+
+    size_t recordSize() const { return width + sizeof(int64_t); }
+    int64_t rowAt(size_t position) const
+    {
+        int64_t row;
+        std::memcpy(&row, &records[position * recordSize() + width], sizeof(row));
+        return row;
+    }
+};
+
+template<typename T>
+void writeBigEndian(uint8_t *out, T value)
+{
+    static_assert(std::is_unsigned_v<T>);
+    for(int i = sizeof(T) - 1; i >= 0; i--)
+    {
+        out[i] = (uint8_t)value;
+        value >>= 8;
+    }
+}
+
+// Width of the value part of the key (without the null flag).
+size_t normalizedValueWidth(const arrow::Column &column)
+{
+    switch(column.type()->id())
+    {
+    case arrow::Type::DICTIONARY: return sizeof(int32_t);
+    case arrow::Type::STRING: return NormalizedKeys::stringPrefixLength;
+    default: return sizeof(uint64_t);
+    }
+}
+
+// Writes the given key of all rows at `offset` of their records.
+void encodeNormalizedKey(NormalizedKeys &keys, size_t offset, const SortBy &sortBy)
+{
+    const auto &column = *sortBy.column;
+    const bool nullable = column.null_count() != 0;
+    const bool descending = sortBy.order == SortOrder::Descending;
+    const uint8_t nullFlag = sortBy.nulls == NullPosition::Before ? 0 : 1;
+    const auto valueOffset = offset + (nullable ? 1 : 0);
+
+    // value bytes of nulls are left zeroed, the flag alone orders them
+    auto record = keys.records.data();
+    const auto handleNull = [&]
+    {
+        record[offset] = nullFlag;
+        record += keys.recordSize();
+    };
+    const auto handleKey = [&] (auto key)
+    {
+        if(nullable)
+            record[offset] = 1 - nullFlag;
+        writeBigEndian(record + valueOffset, descending ? decltype(key)(~key) : key);
+        record += keys.recordSize();
+    };
+
+    if(column.type()->id() == arrow::Type::DICTIONARY)
+    {
+        const auto ranks = dictionaryRanks(column);
+        iterateOverRanks(column, ranks, [&] (int32_t rank) { handleKey((uint32_t)rank); }, handleNull);
+        return;
+    }
+
+    visitType(*column.type(), [&] (auto id)
+    {
+        iterateOver<id.value>(column, [&] (auto value)
+        {
+            if constexpr(id.value == arrow::Type::STRING)
+            {
+                const auto prefix = record + valueOffset;
+                const auto length = std::min(value.size(), NormalizedKeys::stringPrefixLength);
+                if(nullable)
+                    record[offset] = 1 - nullFlag;
+                std::memcpy(prefix, value.data(), length);
+                if(descending)
+                    for(size_t i = 0; i < NormalizedKeys::stringPrefixLength; i++)
+                        prefix[i] = ~prefix[i];
+                record += keys.recordSize();
+            }
+            else
+                handleKey(radixKey(value));
+        }, handleNull);
+    });
+}
+
+NormalizedKeys encodeNormalizedKeys(const std::vector<SortBy> &sortBy)
+{
+    NormalizedKeys keys;
+    std::vector<size_t> offsets;
+    for(auto &key : sortBy)
+    {
+        const auto keyWidth = (key.column->null_count() != 0 ? 1 : 0) + normalizedValueWidth(*key.column);
+        if(keys.width + keyWidth > NormalizedKeys::maxWidth)
+            break;
+
+        offsets.push_back(keys.width);
+        keys.width += keyWidth;
+        if(key.column->type()->id() == arrow::Type::STRING)
+            break;
+        keys.exactKeyCount++;
+    }
+
+    const auto rowCount = sortBy.front().column->length();
+    keys.records.resize(rowCount * keys.recordSize());
+    for(size_t i = 0; i < offsets.size(); i++)
+        encodeNormalizedKey(keys, offsets[i], sortBy[i]);
+    for(int64_t row = 0; row < rowCount; row++)
+        std::memcpy(&keys.records[row * keys.recordSize() + keys.width], &row, sizeof(row));
+    return keys;
+}
+
+// Stable LSD radix sort of the records by their key bytes. Passes over bytes that are the same in all keys are skipped.
+void radixSort(NormalizedKeys &keys)
+{
+    const auto recordSize = keys.recordSize();
+    const auto recordCount = keys.records.size() / recordSize;
+
+    std::vector<std::array<int64_t, 256>> histograms(keys.width);
+    for(size_t record = 0; record < recordCount; record++)
+    {
+        const auto key = &keys.records[record * recordSize];
+        for(size_t i = 0; i < keys.width; i++)
+            histograms[i][key[i]]++;
+    }
+
+    std::vector<uint8_t> buffer(keys.records.size());
+    for(auto i = keys.width; i-- > 0; )
+    {
+        auto &histogram = histograms[i];
+        if(std::find(histogram.begin(), histogram.end(), (int64_t)recordCount) != histogram.end())
+            continue;
+
+        int64_t position = 0;
+        for(auto &count : histogram)
+            position += std::exchange(count, position);
+
+        for(size_t record = 0; record < recordCount; record++)
+        {
+            const auto source = &keys.records[record * recordSize];
+            std::memcpy(&buffer[histogram[source[i]]++ * recordSize], source, recordSize);
+        }
+        keys.records.swap(buffer);
+    }
+}
+
+// Three-way comparison of rows by a single key. Used only for rows that normalized keys don't tell apart.
+std::function<int(int64_t, int64_t)> makeRowComparator(const SortBy &sortBy)
+{
+    return visitType(*sortBy.column->type(), [&] (auto id) -> std::function<int(int64_t, int64_t)>
+    {
+        using ElementType = typename TypeDescription<id.value>::ObservedType;
+        auto values = std::make_shared<std::vector<std::optional<ElementType>>>(toVector<std::optional<ElementType>>(*sortBy.column));
+        const auto descending = sortBy.order == SortOrder::Descending;
+        const auto nullsBefore = sortBy.nulls == NullPosition::Before;
+        return [=] (int64_t lhsRow, int64_t rhsRow)
+        {
+            const auto &lhs = (*values)[lhsRow];
+            const auto &rhs = (*values)[rhsRow];
+            if(!lhs || !rhs)
+                return (!lhs && !rhs) ? 0 : (!lhs == nullsBefore ? -1 : 1);
+
+            // same order as of the radix keys the rows were sorted by, so that merging sorted parts is consistent
+            const auto result = valueLess(*lhs, *rhs) ? -1 : (valueLess(*rhs, *lhs) ? 1 : 0);
+            return descending ? -result : result;
+        };
+    });
+}
+
+// Sorts rows by all keys at once, using their normalized keys.
+Permutation sortPermutationByNormalizedKeys(const std::vector<SortBy> &sortBy)
+{
+    auto keys = encodeNormalizedKeys(sortBy);
+    radixSort(keys);
+
+    const auto recordCount = keys.records.size() / keys.recordSize();
+    Permutation indices(recordCount);
+    for(size_t i = 0; i < recordCount; i++)
+        indices[i] = keys.rowAt(i);
+
+    if(keys.exactKeyCount == sortBy.size())
+        return indices;
+
+    // Rows with equal normalized keys are compared by the remaining keys. As the radix sort is stable, each run
+    // of such rows is in the original order, so stable sorting it keeps the overall sort stable.
+    std::vector<std::function<int(int64_t, int64_t)>> comparators;
+    const auto compareRemainingKeys = [&] (int64_t lhs, int64_t rhs)
+    {
+        if(comparators.empty())
+            for(auto i = keys.exactKeyCount; i < sortBy.size(); i++)
+                comparators.push_back(makeRowComparator(sortBy[i]));
+
+        for(auto &comparator : comparators)
+            if(const auto result = comparator(lhs, rhs))
+                return result < 0;
+        return false;
+    };
+
+    const auto keyAt = [&] (size_t position) { return &keys.records[position * keys.recordSize()]; };
+    for(size_t runStart = 0; runStart < recordCount; )
+    {
+        auto runEnd = runStart + 1;
+        while(runEnd < recordCount && std::memcmp(keyAt(runStart), keyAt(runEnd), keys.width) == 0)
+            runEnd++;
+
+        if(runEnd - runStart > 1)
+            std::stable_sort(indices.begin() + runStart, indices.begin() + runEnd, compareRemainingKeys);
+        runStart = runEnd;
+    }
+    return indices;
+}
+
+Permutation sortPermutationSequential(std::vector<SortBy> sortBy)
+{
+    if(sortBy.size() > 1)
+        return sortPermutationByNormalizedKeys(sortBy);
 
     Permutation indices = iotaVector<int64_t>(sortBy.front().column->length());
 
@@ -215,6 +703,234 @@ std::vector<int64_t> sortPermutation(std::vector<SortBy> sortBy)
     return indices;
 }
 
+// Columns shorter than twice this are sorted by a single thread.
+constexpr int64_t parallelSortMinimumPartLength = 1 << 15;
+
+// Merges sorted ranges [begin, middle) and [middle, end) of `from` into the same positions of `to`, keeping
+// the merge stable. Only the given piece of `pieceCount` is produced: it starts at an element of the first range
+// and takes elements of the second range that are less than it, so that pieces can be merged concurrently.
+template<typename Compare>
+void mergePiece(const Permutation &from, Permutation &to, int64_t begin, int64_t middle, int64_t end, int64_t piece, int64_t pieceCount, Compare &&compare)
+{
+    const auto split = [&] (int64_t piece) -> std::pair<int64_t, int64_t>
+    {
+        if(piece == 0)
+            return { begin, middle };
+
+        const auto first = begin + (middle - begin) * piece / pieceCount;
+        if(first == middle)
+            return { middle, end };
+        return { first, std::lower_bound(from.begin() + middle, from.begin() + end, from[first], compare) - from.begin() };
+    };
+
+    const auto [firstBegin, secondBegin] = split(piece);
+    const auto [firstEnd, secondEnd] = split(piece + 1);
+    std::merge(from.begin() + firstBegin, from.begin() + firstEnd, from.begin() + secondBegin, from.begin() + secondEnd,
+        to.begin() + begin + (firstBegin - begin) + (secondBegin - middle), compare);
+}
+
+// Sorts contiguous row ranges concurrently by the sequential sort, then merges them in rounds of concurrent merges.
+Permutation sortPermutationParallel(const std::vector<SortBy> &sortBy, int threadCount)
+{
+    const auto length = sortBy.front().column->length();
+    const auto partCount = std::min<int64_t>(threadCount, length / parallelSortMinimumPartLength);
+    std::vector<int64_t> partStarts;
+    for(int64_t part = 0; part <= partCount; part++)
+        partStarts.push_back(length * part / partCount);
+
+    Permutation indices(length);
+    parallelFor(partCount, threadCount, [&] (int64_t part)
+    {
+        const auto partStart = partStarts[part];
+        const auto partLength = partStarts[part + 1] - partStart;
+        const auto sortPartBy = transformToVector(sortBy, [&] (const SortBy &key)
+        {
+            return SortBy{ key.column->Slice(partStart, partLength), key.order, key.nulls };
+        });
+        const auto partIndices = sortPermutationSequential(sortPartBy);
+        std::transform(partIndices.begin(), partIndices.end(), indices.begin() + partStart, [&] (int64_t index) { return index + partStart; });
+    });
+
+    std::vector<std::function<int(int64_t, int64_t)>> comparators(sortBy.size());
+    parallelFor(sortBy.size(), threadCount, [&] (int64_t i) { comparators[i] = makeRowComparator(sortBy[i]); });
+    const auto compareRows = [&] (int64_t lhs, int64_t rhs)
+    {
+        for(auto &comparator : comparators)
+            if(const auto result = comparator(lhs, rhs))
+                return result < 0;
+        return false;
+    };
+
+    // Each round merges pairs of neighbouring runs, splitting merges into pieces to keep all threads busy.
+    Permutation merged(length);
+    for(int64_t runParts = 1; runParts < partCount; runParts *= 2)
+    {
+        const auto mergeCount = (partCount + 2 * runParts - 1) / (2 * runParts);
+        const auto piecesPerMerge = std::max<int64_t>(1, threadCount / mergeCount);
+        parallelFor(mergeCount * piecesPerMerge, threadCount, [&] (int64_t task)
+        {
+            const auto firstPart = task / piecesPerMerge * 2 * runParts;
+            const auto begin = partStarts[firstPart];
+            const auto middle = partStarts[std::min(firstPart + runParts, partCount)];
+            const auto end = partStarts[std::min(firstPart + 2 * runParts, partCount)];
+            mergePiece(indices, merged, begin, middle, end, task % piecesPerMerge, piecesPerMerge, compareRows);
+        });
+        indices.swap(merged);
+    }
+    return indices;
+}
+
+// Indices of the first `k` rows in the sorted order. Rows are scanned once, keeping a heap of the best ones seen.
+Permutation topKPermutation(const std::vector<SortBy> &sortBy, int64_t k)
+{
+    const auto comparators = transformToVector(sortBy, makeRowComparator);
+    // rows equal by all keys keep their order, as in the stable sort
+    const auto compareRows = [&] (int64_t lhs, int64_t rhs)
+    {
+        for(auto &comparator : comparators)
+            if(const auto result = comparator(lhs, rhs))
+                return result < 0;
+        return lhs < rhs;
+    };
+
+    Permutation heap; // the worst of the rows taken so far is at the front
+    heap.reserve(k);
+    const auto length = sortBy.front().column->length();
+    for(int64_t row = 0; row < length; row++)
+    {
+        if((int64_t)heap.size() < k)
+        {
+            heap.push_back(row);
+            std::push_heap(heap.begin(), heap.end(), compareRows);
+        }
+        else if(k > 0 && compareRows(row, heap.front()))
+        {
+            std::pop_heap(heap.begin(), heap.end(), compareRows);
+            heap.back() = row;
+            std::push_heap(heap.begin(), heap.end(), compareRows);
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), compareRows);
+    return heap;
+}
+
+Permutation sortPermutation(const std::vector<SortBy> &sortBy)
+{
+    if(sortBy.empty())
+        throw std::runtime_error("no column to sort by");
+
+    const auto threadCount = resolveThreadCount(defaultThreadCount());
+    if(threadCount > 1 && sortBy.front().column->length() >= 2 * parallelSortMinimumPartLength)
+        return sortPermutationParallel(sortBy, threadCount);
+
+    return sortPermutationSequential(sortBy);
+}
+
+// Single pass over the column, see `ColumnOrder`.
+ColumnOrder scanColumnOrder(const arrow::Column &column)
+{
+    ColumnOrder order;
+    bool seenValid = false;
+    bool seenNull = false;
+    visitType(*column.type(), [&] (auto id)
+    {
+        std::optional<ObservedTypeFor<id.value>> previous;
+        iterateOver<id.value>(column, [&] (auto value)
+        {
+            if constexpr(id.value == arrow::Type::DOUBLE)
+                if(std::isnan(value))
+                    order.nonDecreasing = order.nonIncreasing = order.increasing = order.decreasing = false;
+
+            if(previous)
+            {
+                if(value < *previous)
+                    order.nonDecreasing = order.increasing = false;
+                else if(*previous < value)
+                    order.nonIncreasing = order.decreasing = false;
+                else
+                    order.increasing = order.decreasing = false;
+            }
+            previous = value;
+
+            if(seenNull)
+                order.nullsLast = false;
+            seenValid = true;
+        }, [&]
+        {
+            if(seenValid)
+                order.nullsFirst = false;
+            seenNull = true;
+        });
+    });
+    return order;
+}
+
+// Orders of scanned columns, keyed by their data. The data is referenced weakly, so that an entry is not mistaken
+// for one of other data allocated at the same address after the scanned data got freed.
+class ColumnOrderCache
+{
+    struct Entry
+    {
+        std::weak_ptr<arrow::ChunkedArray> data;
+        ColumnOrder order;
+    };
+
+    std::mutex mx;
+    std::unordered_map<const arrow::ChunkedArray *, Entry> entries;
+    size_t pruneAt = 64;
+
+public:
+    std::optional<ColumnOrder> find(const std::shared_ptr<arrow::ChunkedArray> &data)
+    {
+        std::unique_lock<std::mutex> lock{mx};
+        const auto itr = entries.find(data.get());
+        if(itr == entries.end())
+            return std::nullopt;
+        if(itr->second.data.lock() != data)
+        {
+            entries.erase(itr);
+            return std::nullopt;
+        }
+        return itr->second.order;
+    }
+
+    void store(const std::shared_ptr<arrow::ChunkedArray> &data, ColumnOrder order)
+    {
+        std::unique_lock<std::mutex> lock{mx};
+        entries[data.get()] = Entry{ data, order };
+
+        // entries of freed data are dropped once in a while, as the cache grows twice
+        if(entries.size() >= pruneAt)
+        {
+            for(auto itr = entries.begin(); itr != entries.end(); )
+                itr = itr->second.data.expired() ? entries.erase(itr) : std::next(itr);
+            pruneAt = std::max<size_t>(64, entries.size() * 2);
+        }
+    }
+
+    static ColumnOrderCache &instance()
+    {
+        static ColumnOrderCache cache;
+        return cache;
+    }
+};
+
+// Whether stable sorting by the keys would leave the rows as they are. Keys after the first matter only for
+// rows with equal first keys, so they are ignored if there are no such rows.
+bool isSortedBy(const std::vector<SortBy> &sortBy)
+{
+    const auto &first = sortBy.front();
+    const auto order = columnOrder(*first.column);
+    if(!order.sorted(first.order, first.nulls))
+        return false;
+    if(sortBy.size() == 1)
+        return true;
+
+    const auto strictly = first.order == SortOrder::Ascending ? order.increasing : order.decreasing;
+    return strictly && first.column->null_count() <= 1;
+}
+
 }
 
 
@@ -242,8 +958,37 @@ std::shared_ptr<arrow::Table> permute(const std::shared_ptr<arrow::Table> &table
     return permuteInner(table, indices);
 }
 
+ColumnOrder columnOrder(const arrow::Column &column)
+{
+    auto &cache = ColumnOrderCache::instance();
+    if(const auto order = cache.find(column.data()))
+        return *order;
+
+    const auto order = scanColumnOrder(column);
+    cache.store(column.data(), order);
+    return order;
+}
+
 std::shared_ptr<arrow::Table> sortTable(const std::shared_ptr<arrow::Table> &table, const std::vector<SortBy> &sortBy)
 {
+    if(!sortBy.empty() && isSortedBy(sortBy))
+        return table;
+
     auto permutation = sortPermutation(sortBy);
     return permute(table, permutation);
 }
+
+std::shared_ptr<arrow::Table> topK(const std::shared_ptr<arrow::Table> &table, const std::vector<SortBy> &sortBy, int64_t k)
+{
+    if(sortBy.empty())
+        throw std::runtime_error("no column to sort by");
+    if(k < 0)
+        THROW("cannot take {} rows", k);
+    if(k >= table->num_rows())
+        return sortTable(table, sortBy);
+    if(isSortedBy(sortBy))
+        return slice(table, 0, k);
+
+    // not `permute`, which would return the whole table if the rows taken were its leading ones
+    return permuteInner(table, topKPermutation(sortBy, k));
+}
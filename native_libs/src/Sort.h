@@ -39,5 +39,31 @@ struct SortBy
     {}
 };
 
+// Order of column values, as found by scanning them. Orders describe valid values only, positions of nulls are separate.
+// NaN values break all orders.
+struct ColumnOrder
+{
+    bool nonDecreasing = true;
+    bool nonIncreasing = true;
+    bool increasing = true; // strictly
+    bool decreasing = true; // strictly
+    bool nullsFirst = true; // no null follows a valid value
+    bool nullsLast = true; // no valid value follows a null
+
+    // whether stable sorting the column would leave it as is
+    bool sorted(SortOrder order, NullPosition nulls) const
+    {
+        const auto valuesSorted = order == SortOrder::Ascending ? nonDecreasing : nonIncreasing;
+        return valuesSorted && (nulls == NullPosition::Before ? nullsFirst : nullsLast);
+    }
+};
+
+// Scans the column once; the result is remembered for its data (which is immutable), so asking again is cheap.
+DFH_EXPORT ColumnOrder columnOrder(const arrow::Column &column);
+
+// Tables already sorted by the keys are returned as they are. NaN values are sorted as greater than any other value.
 DFH_EXPORT std::shared_ptr<arrow::Table> sortTable(const std::shared_ptr<arrow::Table> &table, const std::vector<SortBy> &sortBy);
 
+// First `k` rows of the table sorted by given keys (whole sorted table if it has no more rows), without sorting it all.
+DFH_EXPORT std::shared_ptr<arrow::Table> topK(const std::shared_ptr<arrow::Table> &table, const std::vector<SortBy> &sortBy, int64_t k);
+
@@ -11,14 +11,18 @@
 #include "Core/Common.h"
 #include "Core/Error.h"
 #include "Core/Logger.h"
+#include "Core/Parallel.h"
 #include "Analysis.h"
 #include "Processing.h"
 #include "Sort.h"
 #include "LifetimeManager.h"
 #include "ValueHolder.h"
 #include "IO/csv.h"
+#include "IO/CsvCache.h"
 #include "IO/Feather.h"
+#include "IO/JSONL.h"
 #include "IO/IO.h"
+#include "IO/LoadJob.h"
 #include "IO/JSON.h"
 #include "IO/XLSX.h"
 
@@ -155,6 +159,17 @@ extern "C"
     {
         Logger::instance().enabled.store(verbose);
     }
+
+    // Thread count for sorting and permuting tables, see `setDefaultThreadCount`.
+    DFH_EXPORT void setThreadCount(int32_t threadCount)
+    {
+        LOG("{}", threadCount);
+        setDefaultThreadCount(threadCount);
+    }
+    DFH_EXPORT int32_t getThreadCount()
+    {
+        return defaultThreadCount();
+    }
 }
 
 // DATATYPE
@@ -752,6 +767,14 @@ extern "C"
             return column->null_count();
         };
     }
+    DFH_EXPORT bool columnIsSorted(arrow::Column *column, SortOrder order, NullPosition nulls, const char **outError) noexcept
+    {
+        LOG("@{} order={} nulls={}", (void*)column, (int)order, (int)nulls);
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            return columnOrder(*column).sorted(order, nulls);
+        };
+    }
     DFH_EXPORT arrow::Field *columnField(arrow::Column *column, const char **outError) noexcept
     {
         LOG("@{}", (void*)column);
@@ -1230,6 +1253,26 @@ extern "C"
             return LifetimeManager::instance().addOwnership(ret);
         };
     }
+    DFH_EXPORT arrow::Table *tableTopK(arrow::Table *table, int32_t columnCount, arrow::Column **columns, SortOrder *columnOrders, NullPosition *nullPositions, int64_t k, const char **outError) noexcept
+    {
+        LOG("@{} k={}", (void*)table, k);
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            std::vector<SortBy> sortBy;
+            for(int i = 0; i < columnCount; i++)
+            {
+                const auto columnManaged = LifetimeManager::instance().accessOwned(columns[i]);
+                if(columnManaged->length() != table->num_rows())
+                    throw std::runtime_error("Column to sort by named '" + columnManaged->name() + "' has different row count than the table to be sorted!");
+
+                sortBy.emplace_back(columnManaged, columnOrders[i], nullPositions[i]);
+            }
+
+            auto tableManaged = LifetimeManager::instance().accessOwned(table);
+            auto ret = topK(tableManaged, sortBy, k);
+            return LifetimeManager::instance().addOwnership(ret);
+        };
+    }
     DFH_EXPORT arrow::Table *tableInterpolateNa(arrow::Table *table, const char **outError) noexcept
     {
         LOG("@{}", (void*)table);
@@ -1303,15 +1346,28 @@ extern "C"
     }
 }
 
-arrow::Table *readTableFromCSVFileContentsHelper(std::string data, const char **columnNames, int32_t columnNamesPolicy, int8_t *columnTypes, int8_t *columnIsNullableTypes, int32_t columnTypeInfoCount)
+CsvReadOptions csvReadOptionsFromC(const char **columnNames, int32_t columnNamesPolicy, int8_t *columnTypes, int8_t *columnIsNullableTypes, int32_t columnTypeInfoCount)
 {
     CsvReadOptions opts;
     opts.header = headerPolicyFromC(columnNamesPolicy, columnNames);
     opts.columnTypes = columnTypesFromC(columnTypeInfoCount, columnTypes, columnIsNullableTypes);
+    return opts;
+}
 
-    auto table = FormatCSV{}.readString(std::move(data), opts);
-    LOG("table has size {}x{}", table->num_columns(), table->num_rows());
-    return LifetimeManager::instance().addOwnership(table);
+// Each of `count` selected columns is given either by name or, if the name is null (or there are no names at all), by index.
+std::vector<ColumnSelector> columnSelectionFromC(const char **columnNames, const int32_t *columnIndices, int32_t count)
+{
+    std::vector<ColumnSelector> ret;
+    for(int32_t i = 0; i < count; i++)
+    {
+        if(columnNames && columnNames[i])
+            ret.push_back(std::string(columnNames[i]));
+        else if(columnIndices)
+            ret.push_back(int(columnIndices[i]));
+        else
+            THROW("column #{} of selection has neither name nor index", i);
+    }
+    return ret;
 }
 
 
@@ -1328,23 +1384,230 @@ extern "C"
         };
     }
 
+    // Reads files matching the pattern (`*` and `?` wildcards are allowed in the file name) into a single chunked table.
+    DFH_EXPORT arrow::Table *readTablesFromFilePattern(const char *pattern, int32_t threadCount, const char **outError)
+    {
+        LOG("@{} threadCount={}", pattern, threadCount);
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            auto table = readTablesFromFiles(std::string_view{pattern}, threadCount);
+            LOG("table has size {}x{}", table->num_columns(), table->num_rows());
+            return LifetimeManager::instance().addOwnership(table);
+        };
+    }
+
+    DFH_EXPORT arrow::Table *readTablesFromFileList(const char **filenames, int32_t fileCount, int32_t threadCount, const char **outError)
+    {
+        LOG("fileCount={} threadCount={}", fileCount, threadCount);
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            const std::vector<std::string> filePaths{ filenames, filenames + fileCount };
+            auto table = readTablesFromFiles(filePaths, threadCount);
+            LOG("table has size {}x{}", table->num_columns(), table->num_rows());
+            return LifetimeManager::instance().addOwnership(table);
+        };
+    }
+
     DFH_EXPORT arrow::Table *readTableFromCSVFileContents(const char *data, const char **columnNames, int32_t columnNamesPolicy, int8_t *columnTypes, int8_t *columnIsNullableTypes, int32_t columnTypeInfoCount, const char **outError)
     {
         LOG("size={} names={}, namesPolicyCode={}, typeInfoCount={}", std::strlen(data), (void*)columnNames, columnNamesPolicy, columnTypeInfoCount);
         return TRANSLATE_EXCEPTION(outError)
         {
-            std::string buffer{ data };
-            return readTableFromCSVFileContentsHelper(std::move(data), columnNames, columnNamesPolicy, columnTypes, columnIsNullableTypes, columnTypeInfoCount);
+            const auto opts = csvReadOptionsFromC(columnNames, columnNamesPolicy, columnTypes, columnIsNullableTypes, columnTypeInfoCount);
+            auto table = FormatCSV{}.readString(data, opts);
+            LOG("table has size {}x{}", table->num_columns(), table->num_rows());
+            return LifetimeManager::instance().addOwnership(table);
         };
     }
 
-    DFH_EXPORT arrow::Table *readTableFromCSVFile(const char *filename, const char **columnNames, int32_t columnNamesPolicy, int8_t *columnTypes, int8_t *columnIsNullableTypes, int32_t columnTypeInfoCount, const char **outError)
+    // `predicate` is an optional (may be null) LQuery JSON, only rows satisfying it are read
+    DFH_EXPORT arrow::Table *readTableFromCSVFile(const char *filename, const char **columnNames, int32_t columnNamesPolicy, int8_t *columnTypes, int8_t *columnIsNullableTypes, int32_t columnTypeInfoCount, int32_t threadCount, const char *predicate, const char **outError)
     {
-        LOG("@{} names={}, namesPolicyCode={}, typeInfoCount={}", filename, (void*)columnNames, columnNamesPolicy, columnTypeInfoCount);
+        LOG("@{} names={}, namesPolicyCode={}, typeInfoCount={}, threadCount={}, predicate={}", filename, (void*)columnNames, columnNamesPolicy, columnTypeInfoCount, threadCount, predicate ? predicate : "none");
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            auto opts = csvReadOptionsFromC(columnNames, columnNamesPolicy, columnTypes, columnIsNullableTypes, columnTypeInfoCount);
+            opts.threadCount = threadCount;
+            if(predicate)
+                opts.predicate = predicate;
+            auto table = FormatCSV{}.read(filename, opts);
+            LOG("table has size {}x{}", table->num_columns(), table->num_rows());
+            return LifetimeManager::instance().addOwnership(table);
+        };
+    }
+
+    // Starts reading the file in the background, the job handle needs release.
+    DFH_EXPORT LoadJob *readTableFromFileAsync(const char *filename, const char **outError)
+    {
+        LOG("@{}", filename);
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            auto job = readTableFromFileAsync(std::string(filename));
+            return LifetimeManager::instance().addOwnership(job);
+        };
+    }
+
+    // Starts `readTableFromCSVFile` in the background, the job handle needs release.
+    DFH_EXPORT LoadJob *readTableFromCSVFileAsync(const char *filename, const char **columnNames, int32_t columnNamesPolicy, int8_t *columnTypes, int8_t *columnIsNullableTypes, int32_t columnTypeInfoCount, int32_t threadCount, const char *predicate, const char **outError)
+    {
+        LOG("@{} names={}, namesPolicyCode={}, typeInfoCount={}, threadCount={}, predicate={}", filename, (void*)columnNames, columnNamesPolicy, columnTypeInfoCount, threadCount, predicate ? predicate : "none");
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            auto opts = csvReadOptionsFromC(columnNames, columnNamesPolicy, columnTypes, columnIsNullableTypes, columnTypeInfoCount);
+            opts.threadCount = threadCount;
+            if(predicate)
+                opts.predicate = predicate;
+            auto job = readTableFromCSVFileAsync(filename, std::move(opts));
+            return LifetimeManager::instance().addOwnership(job);
+        };
+    }
+
+    // Returns LoadJobState code.
+    DFH_EXPORT int8_t loadJobState(LoadJob *job, const char **outError) noexcept
+    {
+        LOG("@{}", (void*)job);
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            return (int8_t)job->state();
+        };
+    }
+
+    // Returns whether the job is done. Negative timeout waits without a limit.
+    DFH_EXPORT bool loadJobWait(LoadJob *job, int64_t timeoutMilliseconds, const char **outError) noexcept
+    {
+        LOG("@{} timeout={}ms", (void*)job, timeoutMilliseconds);
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            if(timeoutMilliseconds < 0)
+            {
+                job->wait();
+                return true;
+            }
+            return job->wait(std::chrono::milliseconds(timeoutMilliseconds));
+        };
+    }
+
+    // Releasing the handle does not stop the job, this does.
+    DFH_EXPORT void loadJobCancel(LoadJob *job, const char **outError) noexcept
+    {
+        LOG("@{}", (void*)job);
         return TRANSLATE_EXCEPTION(outError)
         {
-            auto buffer = getFileContents(filename);
-            return readTableFromCSVFileContentsHelper(std::move(buffer ), columnNames, columnNamesPolicy, columnTypes, columnIsNullableTypes, columnTypeInfoCount);
+            job->cancel();
+        };
+    }
+
+    // -1 if unknown
+    DFH_EXPORT int64_t loadJobBytesTotal(LoadJob *job) noexcept
+    {
+        LOG("@{}", (void*)job);
+        return job->progress().bytesTotal;
+    }
+
+    DFH_EXPORT int64_t loadJobBytesRead(LoadJob *job) noexcept
+    {
+        LOG("@{}", (void*)job);
+        return job->progress().bytesRead;
+    }
+
+    DFH_EXPORT int64_t loadJobRowsParsed(LoadJob *job) noexcept
+    {
+        LOG("@{}", (void*)job);
+        return job->progress().rowsParsed;
+    }
+
+    // Waits for the job to be done. Sets error if the job failed or was cancelled. The table needs release.
+    DFH_EXPORT arrow::Table *loadJobResult(LoadJob *job, const char **outError) noexcept
+    {
+        LOG("@{}", (void*)job);
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            auto table = job->result();
+            return LifetimeManager::instance().addOwnership(table);
+        };
+    }
+
+    // Reads only the selected columns, see `columnSelectionFromC`. Type infos describe columns of the file.
+    DFH_EXPORT arrow::Table *readTableFromCSVFileColumns(const char *filename, const char **columnNames, int32_t columnNamesPolicy, int8_t *columnTypes, int8_t *columnIsNullableTypes, int32_t columnTypeInfoCount, const char **selectedColumnNames, const int32_t *selectedColumnIndices, int32_t selectedColumnCount, int32_t threadCount, const char **outError)
+    {
+        LOG("@{} names={}, namesPolicyCode={}, typeInfoCount={}, selectedCount={}, threadCount={}", filename, (void*)columnNames, columnNamesPolicy, columnTypeInfoCount, selectedColumnCount, threadCount);
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            auto opts = csvReadOptionsFromC(columnNames, columnNamesPolicy, columnTypes, columnIsNullableTypes, columnTypeInfoCount);
+            opts.columns = columnSelectionFromC(selectedColumnNames, selectedColumnIndices, selectedColumnCount);
+            opts.threadCount = threadCount;
+            auto table = FormatCSV{}.read(filename, opts);
+            LOG("table has size {}x{}", table->num_columns(), table->num_rows());
+            return LifetimeManager::instance().addOwnership(table);
+        };
+    }
+
+    // From now on CSV files are read from Arrow IPC copies kept in the directory (made on first read), see CsvCache.
+    DFH_EXPORT void csvCacheEnable(const char *directory, int64_t sizeLimit, const char **outError) noexcept
+    {
+        LOG("@{} sizeLimit={}", directory, sizeLimit);
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            CsvCache::enable(directory, sizeLimit);
+        };
+    }
+
+    DFH_EXPORT void csvCacheDisable(const char **outError) noexcept
+    {
+        LOG("");
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            CsvCache::disable();
+        };
+    }
+
+    // Counters of the currently enabled cache (0 if it is disabled).
+    DFH_EXPORT int64_t csvCacheHits() noexcept
+    {
+        LOG("");
+        const auto cache = CsvCache::active();
+        return cache ? cache->hits() : 0;
+    }
+
+    DFH_EXPORT int64_t csvCacheMisses() noexcept
+    {
+        LOG("");
+        const auto cache = CsvCache::active();
+        return cache ? cache->misses() : 0;
+    }
+
+    // NOTE: needs release (or csvStreamReaderClose)
+    DFH_EXPORT CsvStreamReader *csvStreamReaderOpen(const char *filename, const char **columnNames, int32_t columnNamesPolicy, int8_t *columnTypes, int8_t *columnIsNullableTypes, int32_t columnTypeInfoCount, int64_t batchRowCount, const char **outError)
+    {
+        LOG("@{} names={}, namesPolicyCode={}, typeInfoCount={}, batchRowCount={}", filename, (void*)columnNames, columnNamesPolicy, columnTypeInfoCount, batchRowCount);
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            const auto opts = csvReadOptionsFromC(columnNames, columnNamesPolicy, columnTypes, columnIsNullableTypes, columnTypeInfoCount);
+            auto reader = std::make_shared<CsvStreamReader>(filename, opts, batchRowCount);
+            return LifetimeManager::instance().addOwnership(reader);
+        };
+    }
+
+    // Returns table with the next batch of rows or nullptr if there are no more of them.
+    // NOTE: needs release
+    DFH_EXPORT arrow::Table *csvStreamReaderNextBatch(CsvStreamReader *reader, const char **outError)
+    {
+        LOG("@{}", (void*)reader);
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            std::shared_ptr<arrow::Table> table;
+            if(auto batch = reader->readNext())
+                checkStatus(arrow::Table::FromRecordBatches({ batch }, &table));
+            return LifetimeManager::instance().addOwnership(table);
+        };
+    }
+
+    DFH_EXPORT void csvStreamReaderClose(CsvStreamReader *reader, const char **outError)
+    {
+        LOG("@{}", (void*)reader);
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            LifetimeManager::instance().releaseOwnership(reader);
         };
     }
 
@@ -1409,6 +1672,41 @@ extern "C"
         };
     }
 
+    DFH_EXPORT arrow::Table *readTableFromJSONLFile(const char *filename, int32_t typeDeductionDepth, int32_t threadCount, const char **outError)
+    {
+        LOG("{} typeDeductionDepth={} threadCount={}", filename, typeDeductionDepth, threadCount);
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            JsonlReadOptions options;
+            options.typeDeductionDepth = typeDeductionDepth;
+            options.threadCount = threadCount;
+            auto table = FormatJSONL{}.read(filename, options);
+            return LifetimeManager::instance().addOwnership(std::move(table));
+        };
+    }
+
+    DFH_EXPORT void writeTableToJSONLFile(const char *filename, arrow::Table *table, const char **outError)
+    {
+        LOG("{} @{}", filename, (void*)table);
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            FormatJSONL{}.write(filename, *table);
+        };
+    }
+
+    // Columns of the returned table are resolved when first accessed (their data is memory-mapped either way).
+    DFH_EXPORT arrow::Table *readTableFromFeatherFileLazily(const char *filename, const char **outError)
+    {
+        LOG("{}", filename);
+        return TRANSLATE_EXCEPTION(outError)
+        {
+            FeatherReadOptions options;
+            options.lazy = true;
+            auto table = FormatFeather{}.read(filename, options);
+            return LifetimeManager::instance().addOwnership(std::move(table));
+        };
+    }
+
     DFH_EXPORT void writeTableToFeatherFile(const char *filename, arrow::Table *table, const char **outError)
     {
         LOG("table={}, filepath={}", (void*)table, filename);
@@ -3,15 +3,18 @@
 
 #include <rapidjson/filereadstream.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <fstream>
 #include <random>
 
 #include "IO/csv.h"
+#include "IO/CsvScanner.h"
 #include "IO/Feather.h"
 #include "Analysis.h"
 #include "Core/Benchmark.h"
 #include "Processing.h"
+#include "Sort.h"
 #include "Fixture.h"
 #include "Core/Utils.h"
 
@@ -199,12 +202,19 @@ BOOST_AUTO_TEST_CASE(StatisticsBigFile)
 
 BOOST_AUTO_TEST_CASE(ParseBigFile)
 {
-	measure("parse big file", 20, [&]
+	// compare scanning implementations, from scalar to the best one available
+	const auto bestSimdLevel = detectedSimdLevel();
+	for(auto level = SimdLevel::Scalar; level <= bestSimdLevel; level = SimdLevel((int)level + 1))
 	{
-		auto table = FormatCSV{}.read("C:/installments_payments.csv");
+		setSimdLevel(level);
+		measure("parse big file with SIMD level " + std::to_string((int)level), 20, [&]
+		{
+			auto table = FormatCSV{}.read("C:/installments_payments.csv");
 
-		//FormatFeather{}.write("C:/installments_payments.feather", *table);
-	});
+			//FormatFeather{}.write("C:/installments_payments.feather", *table);
+		});
+	}
+	setSimdLevel(bestSimdLevel);
 
 	auto integerType = std::make_shared<arrow::Int64Type>();
 	auto doubleType = std::make_shared<arrow::DoubleType>();
@@ -236,6 +246,39 @@ BOOST_AUTO_TEST_CASE(ParseBigFile)
 }
 
 
+BOOST_AUTO_TEST_CASE(ParseTimestampFields)
+{
+	// timestamp fields should be parsed about as fast as integer ones
+	std::mt19937 generator{ 0 };
+	std::uniform_int_distribution<int64_t> days{ 0, 365 * 60 };
+	std::uniform_int_distribution<int64_t> seconds{ 0, 86399 };
+
+	std::vector<std::string> dates, dateTimes, integers;
+	for(int i = 0; i < 1'000'000; i++)
+	{
+		const auto day = date::sys_days{ date::days{ days(generator) } };
+		dates.push_back(date::format("%F", day));
+		dateTimes.push_back(date::format("%FT%TZ", day + std::chrono::seconds{ seconds(generator) }));
+		integers.push_back(std::to_string(day.time_since_epoch().count() * 86400));
+	}
+
+	const auto parseAll = [] (auto type, const std::vector<std::string> &fields)
+	{
+		int64_t parsedCount = 0;
+		for(auto &field : fields)
+			parsedCount += Parser::as<decltype(type)>(field).has_value();
+		return parsedCount;
+	};
+	benchmark("parse integers", parseAll, int64_t{}, integers);
+	benchmark("parse dates", parseAll, Timestamp{}, dates);
+	benchmark("parse date times", parseAll, Timestamp{}, dateTimes);
+
+	std::string csv = "date,int\n";
+	for(size_t i = 0; i < dates.size(); i++)
+		csv += dates[i] + "," + integers[i] + "\n";
+	benchmark("read csv with timestamps", [&] { return FormatCSV{}.readString(csv, CsvReadOptions{}); });
+}
+
 BOOST_AUTO_TEST_CASE(WriteBigFile)
 {
 	const auto path = R"(E:/hmda_lar-florida.csv)";
@@ -253,6 +296,53 @@ BOOST_AUTO_TEST_CASE(WriteBigFile)
             FormatCSV{}.write("ffffff.csv", *table);
 		});
 	}
+
+	CsvWriteOptions options;
+	options.threadCount = 0;
+	for(int i = 0; i < 10; i++)
+	{
+		measure("write big file in parallel", [&]
+		{
+            FormatCSV{}.write("ffffff.csv", *table, options);
+		});
+	}
+}
+
+BOOST_AUTO_TEST_CASE(SortByNumericKeys)
+{
+    // radix sort of the keys against stable sorting by comparing values, which it replaced
+    const int64_t length = 10'000'000;
+    std::mt19937 generator{ 0 };
+    std::uniform_int_distribution<int64_t> intDistribution{};
+    std::uniform_real_distribution<double> doubleDistribution{ -1e6, 1e6 };
+    std::uniform_int_distribution<int64_t> timestampDistribution{ 0, 50 * 365 * 86'400'000'000'000LL };
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+    std::vector<Timestamp> timestamps;
+    for(int64_t i = 0; i < length; i++)
+    {
+        ints.push_back(intDistribution(generator));
+        doubles.push_back(doubleDistribution(generator));
+        timestamps.push_back(Timestamp(timestampDistribution(generator)));
+    }
+    const auto table = tableFromVectors(ints, doubles, timestamps);
+
+    const auto compareSorts = [&] (std::string typeName, int columnIndex, auto valueTag)
+    {
+        using T = decltype(valueTag);
+        const auto column = table->column(columnIndex);
+        benchmark("sort by " + typeName + " with radix sort", [&] { return sortTable(table, { { column } }); });
+        benchmark("sort by " + typeName + " with comparisons", [&]
+        {
+            const auto values = toVector<T>(*column);
+            auto indices = iotaVector(length);
+            std::stable_sort(indices.begin(), indices.end(), [&] (int64_t lhs, int64_t rhs) { return values[lhs] < values[rhs]; });
+            return permute(table, indices);
+        });
+    };
+    compareSorts("int64", 0, int64_t{});
+    compareSorts("double", 1, double{});
+    compareSorts("timestamp", 2, Timestamp(0));
 }
 
 BOOST_FIXTURE_TEST_CASE(InterpolateBigColumn, DataGenerator)
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "Core/ArrowUtilities.h"
+#include "Core/Parallel.h"
 
 namespace arrow
 {
@@ -13,6 +14,23 @@ namespace arrow
     class Table;
 }
 
+// Sets the default thread count for its lifetime, restoring the previous one even if the test throws.
+struct DefaultThreadCountOverride
+{
+    int previousThreadCount = defaultThreadCount();
+
+    explicit DefaultThreadCountOverride(int threadCount)
+    {
+        setDefaultThreadCount(threadCount);
+    }
+    ~DefaultThreadCountOverride()
+    {
+        setDefaultThreadCount(previousThreadCount);
+    }
+    DefaultThreadCountOverride(const DefaultThreadCountOverride &) = delete;
+    DefaultThreadCountOverride &operator=(const DefaultThreadCountOverride &) = delete;
+};
+
 // TODO: use non-aligned begins with nulls
 struct ChunkedFixture
 {
@@ -5,19 +5,32 @@
 #define BOOST_TEST_MODULE DataframeHelperTests
 #include <boost/test/unit_test.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
 
 #include <chrono>
+#include <cmath>
 #include <fstream>
+#include <limits>
 #include <numeric>
 #include <random>
+#include <thread>
 
 #include <date/date.h>
 
+#include "IO/ArrowIPC.h"
+#include "IO/Compression.h"
 #include "IO/csv.h"
+#include "IO/CsvCache.h"
+#include "IO/CsvScanner.h"
 #include "IO/IO.h"
 #include "IO/Feather.h"
+#include "IO/JSONL.h"
+#include "IO/LoadJob.h"
+#include "IO/Parquet.h"
 #include "Core/ArrowUtilities.h"
 #include "Core/Benchmark.h"
+#include "Core/LazyTable.h"
+#include "Core/Parallel.h"
 #include "optional.h"
 #include "Processing.h"
 #include "Sort.h"
@@ -129,6 +142,322 @@ BOOST_AUTO_TEST_CASE(SortSimple)
         { 3, 4, 8, 7, 5, 1, 2, 6, 0 });
 }
 
+BOOST_AUTO_TEST_CASE(SortLargeNumericColumns)
+{
+    // long enough to be radix sorted, with many repeated values to check stability
+    const int64_t length = 5000;
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<int> distribution{-20, 20};
+    std::vector<std::optional<int64_t>> ints;
+    std::vector<std::optional<double>> doubles;
+    std::vector<Timestamp> timestamps;
+    for(int64_t i = 0; i < length; i++)
+    {
+        const auto value = distribution(generator);
+        ints.push_back(value % 7 == 0 ? std::nullopt : std::optional<int64_t>(value * 1'000'000'000'000LL));
+        // -0.0 and 0.0 compare equal, so they must keep their order
+        doubles.push_back(value % 5 == 0 ? std::nullopt : std::optional<double>(std::abs(value) == 1 ? value * 0.0 : value / 8.0));
+        timestamps.push_back(Timestamp(distribution(generator) * 86'400'000'000'000LL));
+    }
+    const auto iota = iotaVector(length);
+    const auto table = tableFromVectors(ints, doubles, timestamps, iota);
+
+    // -1, 0, 1 for less, equal, greater in the requested order
+    const auto compare = [] (auto &&lhs, auto &&rhs, SortOrder order, NullPosition nulls)
+    {
+        if(!lhs || !rhs)
+            return (!lhs && !rhs) ? 0 : ((!lhs == (nulls == NullPosition::Before)) ? -1 : 1);
+        const auto result = *lhs < *rhs ? -1 : (*rhs < *lhs ? 1 : 0);
+        return order == SortOrder::Ascending ? result : -result;
+    };
+
+    auto expected = iota;
+    std::stable_sort(expected.begin(), expected.end(), [&] (int64_t lhs, int64_t rhs)
+    {
+        if(const auto byInts = compare(ints[lhs], ints[rhs], SortOrder::Ascending, NullPosition::After))
+            return byInts < 0;
+        return compare(doubles[lhs], doubles[rhs], SortOrder::Descending, NullPosition::Before) < 0;
+    });
+    const auto sorted = sortTable(table, { { table->column(0), SortOrder::Ascending, NullPosition::After }, { table->column(1), SortOrder::Descending, NullPosition::Before } });
+    const auto [sortedIota] = toVectors<int64_t>(*tableFromColumns({ sorted->column(3) }));
+    BOOST_CHECK_EQUAL_RANGES(sortedIota, expected);
+
+    auto expectedByTimestamps = iota;
+    std::stable_sort(expectedByTimestamps.begin(), expectedByTimestamps.end(), [&] (int64_t lhs, int64_t rhs) { return timestamps[lhs] > timestamps[rhs]; });
+    const auto sortedByTimestamps = sortTable(table, { { table->column(2), SortOrder::Descending } });
+    const auto [sortedIota2] = toVectors<int64_t>(*tableFromColumns({ sortedByTimestamps->column(3) }));
+    BOOST_CHECK_EQUAL_RANGES(sortedIota2, expectedByTimestamps);
+
+    // NaNs are equal and greater than any other value whatever their sign bit, both with and without radix sort
+    const auto nan = std::numeric_limits<double>::quiet_NaN();
+    const auto infinity = std::numeric_limits<double>::infinity();
+    std::vector<double> withNaNs;
+    for(int64_t i = 0; i < length; i++)
+    {
+        const auto value = distribution(generator);
+        withNaNs.push_back(value % 6 == 0 ? std::copysign(nan, value) : (std::abs(value) == 20 ? value * infinity : value / 4.0));
+    }
+    const auto lessWithNaNs = [] (double lhs, double rhs) { return std::isnan(rhs) ? !std::isnan(lhs) : lhs < rhs; };
+    for(const int64_t rowCount : { length, (int64_t)100 })
+    {
+        for(const auto order : { SortOrder::Ascending, SortOrder::Descending })
+        {
+            const std::vector<double> values(withNaNs.begin(), withNaNs.begin() + rowCount);
+            auto expectedWithNaNs = iotaVector(rowCount);
+            std::stable_sort(expectedWithNaNs.begin(), expectedWithNaNs.end(), [&] (int64_t lhs, int64_t rhs)
+            {
+                return order == SortOrder::Ascending ? lessWithNaNs(values[lhs], values[rhs]) : lessWithNaNs(values[rhs], values[lhs]);
+            });
+            const auto nanTable = tableFromVectors(values, iotaVector(rowCount));
+            const auto sortedWithNaNs = sortTable(nanTable, { { nanTable->column(0), order } });
+            const auto [sortedIota3] = toVectors<int64_t>(*tableFromColumns({ sortedWithNaNs->column(1) }));
+            BOOST_CHECK_EQUAL_RANGES(sortedIota3, expectedWithNaNs);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SortByManyKeys)
+{
+    // strings sharing long prefixes are not told apart by their normalized keys,
+    // and five nullable keys do not fit in them at all
+    const int64_t length = 3000;
+    std::mt19937 generator{7};
+    std::uniform_int_distribution<int> distribution{0, 30};
+    std::vector<std::optional<std::string>> strings;
+    std::vector<std::optional<int64_t>> ints;
+    std::vector<std::optional<double>> doubles;
+    for(int64_t i = 0; i < length; i++)
+    {
+        const auto value = distribution(generator);
+        strings.push_back(value == 0 ? std::nullopt : std::optional<std::string>(fmt::format("prefix_{:06}", value % 13)));
+        ints.push_back(value % 11 == 0 ? std::nullopt : std::optional<int64_t>(distribution(generator) % 4 - 2));
+        doubles.push_back(value % 9 == 0 ? std::nullopt : std::optional<double>(distribution(generator) % 5 / 2.0));
+    }
+    const auto iota = iotaVector(length);
+    const auto table = tableFromVectors(strings, ints, doubles, iota);
+
+    const auto compare = [] (auto &&lhs, auto &&rhs, SortOrder order, NullPosition nulls)
+    {
+        if(!lhs || !rhs)
+            return (!lhs && !rhs) ? 0 : ((!lhs == (nulls == NullPosition::Before)) ? -1 : 1);
+        const auto result = *lhs < *rhs ? -1 : (*rhs < *lhs ? 1 : 0);
+        return order == SortOrder::Ascending ? result : -result;
+    };
+
+    auto expected = iota;
+    std::stable_sort(expected.begin(), expected.end(), [&] (int64_t lhs, int64_t rhs)
+    {
+        if(const auto byInts = compare(ints[lhs], ints[rhs], SortOrder::Descending, NullPosition::Before))
+            return byInts < 0;
+        if(const auto byStrings = compare(strings[lhs], strings[rhs], SortOrder::Descending, NullPosition::After))
+            return byStrings < 0;
+        return compare(doubles[lhs], doubles[rhs], SortOrder::Ascending, NullPosition::After) < 0;
+    });
+    const auto sorted = sortTable(table,
+        { { table->column(1), SortOrder::Descending, NullPosition::Before }
+        , { table->column(0), SortOrder::Descending, NullPosition::After }
+        , { table->column(2), SortOrder::Ascending,  NullPosition::After } });
+    const auto [sortedIota] = toVectors<int64_t>(*tableFromColumns({ sorted->column(3) }));
+    BOOST_CHECK_EQUAL_RANGES(sortedIota, expected);
+
+    auto expectedByFiveKeys = iota;
+    std::stable_sort(expectedByFiveKeys.begin(), expectedByFiveKeys.end(), [&] (int64_t lhs, int64_t rhs)
+    {
+        if(const auto result = compare(doubles[lhs], doubles[rhs], SortOrder::Ascending, NullPosition::Before))
+            return result < 0;
+        if(const auto result = compare(ints[lhs], ints[rhs], SortOrder::Ascending, NullPosition::After))
+            return result < 0;
+        if(const auto result = compare(doubles[lhs], doubles[rhs], SortOrder::Descending, NullPosition::After))
+            return result < 0;
+        if(const auto result = compare(ints[lhs], ints[rhs], SortOrder::Descending, NullPosition::Before))
+            return result < 0;
+        return compare(strings[lhs], strings[rhs], SortOrder::Ascending, NullPosition::Before) < 0;
+    });
+    const auto sortedByFiveKeys = sortTable(table,
+        { { table->column(2), SortOrder::Ascending,  NullPosition::Before }
+        , { table->column(1), SortOrder::Ascending,  NullPosition::After }
+        , { table->column(2), SortOrder::Descending, NullPosition::After }
+        , { table->column(1), SortOrder::Descending, NullPosition::Before }
+        , { table->column(0), SortOrder::Ascending,  NullPosition::Before } });
+    const auto [sortedIota2] = toVectors<int64_t>(*tableFromColumns({ sortedByFiveKeys->column(3) }));
+    BOOST_CHECK_EQUAL_RANGES(sortedIota2, expectedByFiveKeys);
+}
+
+BOOST_AUTO_TEST_CASE(SortByDictionaryWithRepeatedValues)
+{
+    // dictionary values need not be unique, rows of equal values must be ordered by the next key
+    const std::vector<std::string> dictionaryValues{ "b", "a", "b", "c", "a" };
+    const int64_t length = 200;
+    std::mt19937 generator{11};
+    std::uniform_int_distribution<int32_t> distribution{0, (int32_t)dictionaryValues.size() - 1};
+    arrow::Int32Builder codeBuilder;
+    std::vector<std::string> strings;
+    std::vector<int64_t> ints;
+    for(int64_t i = 0; i < length; i++)
+    {
+        const auto code = distribution(generator);
+        checkStatus(codeBuilder.Append(code));
+        strings.push_back(dictionaryValues[code]);
+        ints.push_back(distribution(generator));
+    }
+    const auto type = arrow::dictionary(arrow::int32(), toArray(dictionaryValues));
+    const auto dictionaryColumn = toColumn(std::make_shared<arrow::DictionaryArray>(type, finish(codeBuilder)), "dictionary");
+    const auto iota = iotaVector(length);
+    const auto table = tableFromColumns({ dictionaryColumn, toColumn(ints, "ints"), toColumn(iota, "iota") });
+
+    auto expected = iota;
+    std::stable_sort(expected.begin(), expected.end(), [&] (int64_t lhs, int64_t rhs)
+    {
+        return std::make_tuple(strings[lhs], -ints[lhs]) < std::make_tuple(strings[rhs], -ints[rhs]);
+    });
+    const auto sorted = sortTable(table,
+        { { table->column(0), SortOrder::Ascending }
+        , { table->column(1), SortOrder::Descending } });
+    const auto [sortedIota] = toVectors<int64_t>(*tableFromColumns({ sorted->column(2) }));
+    BOOST_CHECK_EQUAL_RANGES(sortedIota, expected);
+}
+
+BOOST_AUTO_TEST_CASE(SortInParallel)
+{
+    // long enough to be split into several sorted and permuted parts
+    const int64_t length = 300'000;
+    std::mt19937 generator{11};
+    std::uniform_int_distribution<int> distribution{0, 1000};
+    std::vector<std::optional<int64_t>> ints;
+    std::vector<std::optional<std::string>> strings;
+    std::vector<double> doubles; // with NaNs of both signs, which must not break merging the sorted parts
+    for(int64_t i = 0; i < length; i++)
+    {
+        const auto value = distribution(generator);
+        ints.push_back(value % 17 == 0 ? std::nullopt : std::optional<int64_t>(value % 50));
+        strings.push_back(value % 23 == 0 ? std::nullopt : std::optional<std::string>(std::to_string(distribution(generator))));
+        doubles.push_back(value % 13 == 0 ? std::copysign(std::numeric_limits<double>::quiet_NaN(), value % 2 ? -1.0 : 1.0) : value / 8.0);
+    }
+    const auto table = tableFromVectors(ints, strings, iotaVector(length));
+    const auto doublesTable = tableFromVectors(ints, doubles, iotaVector(length));
+
+    const std::vector<SortBy> sortBy
+        { { table->column(0), SortOrder::Descending, NullPosition::After }
+        , { table->column(1), SortOrder::Ascending,  NullPosition::Before } };
+    const auto sortedSequentially = sortTable(table, sortBy);
+
+    const std::vector<SortBy> sortByDoubles
+        { { doublesTable->column(1), SortOrder::Descending }
+        , { doublesTable->column(0), SortOrder::Ascending, NullPosition::After } };
+    const auto [sortedInParallel, sortedByStringsInParallel, sortedByDoublesInParallel] = [&]
+    {
+        DefaultThreadCountOverride threadCount{4};
+        return std::make_tuple(sortTable(table, sortBy), sortTable(table, { sortBy[1] }), sortTable(doublesTable, sortByDoubles));
+    }();
+
+    BOOST_CHECK_EQUAL(sortedSequentially->column(0)->data()->num_chunks(), 1);
+    BOOST_CHECK_EQUAL(sortedInParallel->column(0)->data()->num_chunks(), 2);
+    BOOST_CHECK(sortedSequentially->Equals(*sortedInParallel));
+    BOOST_CHECK(sortTable(table, { sortBy[1] })->Equals(*sortedByStringsInParallel));
+
+    const auto [sortedIota] = toVectors<int64_t>(*tableFromColumns({ sortTable(doublesTable, sortByDoubles)->column(2) }));
+    const auto [sortedIotaInParallel] = toVectors<int64_t>(*tableFromColumns({ sortedByDoublesInParallel->column(2) }));
+    BOOST_CHECK_EQUAL_RANGES(sortedIotaInParallel, sortedIota);
+}
+
+BOOST_AUTO_TEST_CASE(TakeTopRows)
+{
+    const int64_t length = 2000;
+    std::mt19937 generator{5};
+    std::uniform_int_distribution<int> distribution{0, 100};
+    std::vector<std::optional<int64_t>> ints;
+    std::vector<std::optional<std::string>> strings;
+    for(int64_t i = 0; i < length; i++)
+    {
+        const auto value = distribution(generator);
+        ints.push_back(value % 13 == 0 ? std::nullopt : std::optional<int64_t>(value % 10));
+        strings.push_back(value % 7 == 0 ? std::nullopt : std::optional<std::string>(std::to_string(distribution(generator) % 20)));
+    }
+    const auto table = tableFromVectors(ints, strings, iotaVector(length));
+
+    const std::vector<std::vector<SortBy>> sortBys
+    {
+        { { table->column(0), SortOrder::Descending, NullPosition::Before } },
+        { { table->column(0), SortOrder::Ascending, NullPosition::After }, { table->column(1), SortOrder::Descending, NullPosition::Before } },
+        { { table->column(1), SortOrder::Ascending, NullPosition::After }, { table->column(0), SortOrder::Ascending, NullPosition::Before } },
+    };
+    for(auto &sortBy : sortBys)
+    {
+        const auto sorted = sortTable(table, sortBy);
+        for(int64_t k : { 0, 1, 100, 1999, 2000, 3000 })
+        {
+            BOOST_TEST_CONTEXT("k=" << k)
+            {
+                const auto top = topK(table, sortBy, k);
+                BOOST_CHECK_EQUAL(top->num_rows(), std::min(k, length));
+                BOOST_CHECK(top->Equals(*slice(sorted, 0, std::min(k, length))));
+            }
+        }
+    }
+    BOOST_CHECK_THROW(topK(table, sortBys.front(), -1), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(SortedColumnFastPaths)
+{
+    const int64_t length = 300;
+    std::vector<std::optional<int64_t>> ints; // ascending with repeats, nulls first
+    std::vector<std::optional<double>> doubles; // strictly descending, nulls last
+    for(int64_t i = 0; i < length; i++)
+    {
+        ints.push_back(i < 3 ? std::nullopt : std::optional<int64_t>(i / 3));
+        doubles.push_back(i >= length - 2 ? std::nullopt : std::optional<double>(100 - i * 0.5));
+    }
+    const auto iota = iotaVector(length);
+    const auto table = tableFromVectors(ints, doubles, iota);
+
+    const auto intsOrder = columnOrder(*table->column(0));
+    BOOST_CHECK(intsOrder.nonDecreasing && !intsOrder.increasing && !intsOrder.nonIncreasing);
+    BOOST_CHECK(intsOrder.nullsFirst && !intsOrder.nullsLast);
+    BOOST_CHECK(intsOrder.sorted(SortOrder::Ascending, NullPosition::Before));
+    BOOST_CHECK(!intsOrder.sorted(SortOrder::Ascending, NullPosition::After));
+    const auto doublesOrder = columnOrder(*table->column(1));
+    BOOST_CHECK(doublesOrder.decreasing && doublesOrder.nullsLast && !doublesOrder.nonDecreasing);
+    BOOST_CHECK(!columnOrder(*toColumn(std::vector<double>{ 1.0, std::nan(""), 2.0 })).sorted(SortOrder::Ascending, NullPosition::Before));
+    BOOST_CHECK(!columnOrder(*toColumn(std::vector<std::string>{ "b", "a", "c" })).sorted(SortOrder::Ascending, NullPosition::Before));
+
+    // sorted tables are returned as they are, but not if a later key has to break ties of the first one
+    BOOST_CHECK_EQUAL(sortTable(table, { { table->column(0) } }).get(), table.get());
+    BOOST_CHECK_EQUAL(sortTable(table, { { table->column(1), SortOrder::Descending, NullPosition::After } }).get(), table.get());
+    BOOST_CHECK_EQUAL(sortTable(table, { { table->column(2) }, { table->column(0), SortOrder::Descending } }).get(), table.get());
+    const auto sortedByTwoKeys = sortTable(table, { { table->column(0) }, { table->column(2), SortOrder::Descending } });
+    BOOST_CHECK(!sortedByTwoKeys->Equals(*table));
+    BOOST_CHECK(topK(table, { { table->column(2) } }, 10)->Equals(*slice(table, 0, 10)));
+
+    // range predicates on sorted columns select the same rows as evaluated ones would
+    const auto checkFilter = [&] (const char *jsonQuery, auto &&matches)
+    {
+        BOOST_TEST_CONTEXT(jsonQuery)
+        {
+            std::vector<int64_t> expected;
+            std::copy_if(iota.begin(), iota.end(), std::back_inserter(expected), matches);
+            const auto filtered = filter(table, jsonQuery);
+            const auto [filteredIota] = toVectors<int64_t>(*tableFromColumns({ filtered->column(2) }));
+            BOOST_CHECK_EQUAL_RANGES(filteredIota, expected);
+        }
+    };
+    checkFilter(R"({"boolean": "and", "arguments": [ {"predicate": "gt", "arguments": [ {"column": "col0"}, 10 ] }, {"predicate": "lt", "arguments": [ {"column": "col0"}, 20 ] } ] })",
+        [&] (int64_t row) { return ints[row] && *ints[row] > 10 && *ints[row] < 20; });
+    checkFilter(R"({"predicate": "eq", "arguments": [ {"column": "col0"}, 15 ] })",
+        [&] (int64_t row) { return ints[row] && *ints[row] == 15; });
+    checkFilter(R"({"predicate": "lt", "arguments": [ 95, {"column": "col0"} ] })",
+        [&] (int64_t row) { return ints[row] && *ints[row] > 95; });
+    checkFilter(R"({"predicate": "gt", "arguments": [ {"column": "col0"}, 1000 ] })",
+        [&] (int64_t row) { return false; });
+    checkFilter(R"({"predicate": "gt", "arguments": [ {"column": "col1"}, 60.5 ] })",
+        [&] (int64_t row) { return doubles[row] && *doubles[row] > 60.5; });
+    checkFilter(R"({"boolean": "and", "arguments": [ {"predicate": "lt", "arguments": [ {"column": "col1"}, 30 ] }, {"predicate": "gt", "arguments": [ {"column": "col1"}, 2 ] } ] })",
+        [&] (int64_t row) { return doubles[row] && *doubles[row] < 30 && *doubles[row] > 2; });
+
+    const date::sys_days day = 2013_y / jan / 01;
+    const auto unorderedTimestamps = toColumn(std::vector<Timestamp>{ day + 2s, day + 1s, day + 3s });
+    BOOST_CHECK_THROW(collectRollingIntervalSizes(unorderedTimestamps, 2s), std::exception);
+}
+
 void testFieldParser(std::string input, std::string expectedContent, int expectedPosition)
 {
 	CsvParser parser{input};
@@ -234,6 +563,372 @@ BOOST_AUTO_TEST_CASE(ParseCsv)
     testCsvParser("a,v\n10,20\n", { {"a", "v"}, {"10", "20"} });
 }
 
+BOOST_AUTO_TEST_CASE(CsvScannerSimdLevels)
+{
+    // random text with many structural characters, long enough to go through vectorized loops
+    std::mt19937 generator{ 0 };
+    const std::string alphabet = "ab\",\r\n";
+    std::string text(1000, ' ');
+    for(auto &c : text)
+        c = alphabet[generator() % alphabet.size()];
+
+    const auto bestSimdLevel = detectedSimdLevel();
+    const auto begin = text.data(), end = text.data() + text.size();
+    for(int start = 0; start < 200; start++)
+    {
+        setSimdLevel(SimdLevel::Scalar);
+        bool expectedInQuotes = start % 2;
+        const auto expectedSeparator = findUnquotedSeparator(begin + start, end, '\n', '"', expectedInQuotes);
+        const auto expectedStructural = findFirstOf(begin + start, end, ',', '\n', '\r');
+
+        for(auto level = SimdLevel::SSE2; level <= bestSimdLevel; level = SimdLevel((int)level + 1))
+        {
+            setSimdLevel(level);
+            bool inQuotes = start % 2;
+            BOOST_CHECK(findUnquotedSeparator(begin + start, end, '\n', '"', inQuotes) == expectedSeparator);
+            BOOST_CHECK_EQUAL(inQuotes, expectedInQuotes);
+            BOOST_CHECK(findFirstOf(begin + start, end, ',', '\n', '\r') == expectedStructural);
+        }
+    }
+    setSimdLevel(bestSimdLevel);
+
+    testCsvParser("\"long quoted field with \"\"escaped\"\" quotes, separators\nand newlines\",x\r\n\"\"\"\"", { {"long quoted field with \"escaped\" quotes, separators\nand newlines", "x"}, {"\""} });
+}
+
+BOOST_AUTO_TEST_CASE(ParseCsvTiles)
+{
+    std::string csv = "a,b,c\n1,2\n\"x\"\"y\",,3,4\n5";
+    CsvParser parser{ csv };
+    const auto tiles = parser.parseCsvTiles(2);
+    BOOST_REQUIRE_EQUAL(tiles.size(), 2);
+    BOOST_CHECK_EQUAL(tiles[0].rowCount, 2);
+    BOOST_CHECK_EQUAL(tiles[0].columnCount, 3);
+    BOOST_CHECK_EQUAL(tiles[1].columnCount, 4);
+    BOOST_CHECK_EQUAL(tiles[0].field(1, 1), "2");
+    BOOST_CHECK(!tiles[0].hasField(2, 1));
+    BOOST_CHECK_EQUAL(tiles[1].field(0, 0), "x\"y");
+    BOOST_CHECK(tiles[1].hasField(1, 0)); // empty, but present
+    BOOST_CHECK_EQUAL(tiles[1].field(1, 0), "");
+    BOOST_CHECK(!tiles[1].hasField(3, 1));
+
+    // many tiles, records of varying length
+    std::string bigCsv = "i,s\n";
+    for(int i = 0; i < 20000; i++)
+        bigCsv += i % 3 ? std::to_string(i) + ",text\n" : std::to_string(i) + "\n";
+    const auto table = FormatCSV{}.readString(bigCsv, CsvReadOptions{});
+    auto [ints, strings] = toVectors<int64_t, std::optional<std::string>>(*table);
+    BOOST_REQUIRE_EQUAL(ints.size(), 20000);
+    for(int i = 0; i < 20000; i++)
+    {
+        BOOST_CHECK_EQUAL(ints[i], i);
+        BOOST_CHECK_EQUAL(strings[i].has_value(), i % 3 != 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ParseCsvParallel)
+{
+    std::string csv = "name,value,description\n";
+    for(int i = 0; i < 1000; i++)
+        csv += "item" + std::to_string(i) + "," + std::to_string(i * 0.5) + ",\"multi\nline, \"\"quoted\"\"\n" + std::to_string(i) + "\"\n";
+
+    auto boundaries = findCsvChunkBoundaries(csv.data(), csv.data() + csv.size(), 4);
+    BOOST_REQUIRE_EQUAL(boundaries.size(), 5);
+    for(auto boundary : boundaries)
+        BOOST_CHECK(boundary == csv.data() || boundary[-1] == '\n');
+
+    CsvReadOptions options;
+    auto tableSequential = FormatCSV{}.readString(csv, options);
+    options.threadCount = 4;
+    auto tableParallel = FormatCSV{}.readString(csv, options);
+
+    BOOST_CHECK_EQUAL(tableParallel->num_rows(), 1000);
+    BOOST_CHECK_EQUAL(tableParallel->column(0)->data()->num_chunks(), 4);
+    BOOST_CHECK(tableSequential->Equals(*tableParallel));
+}
+
+BOOST_AUTO_TEST_CASE(ReadCsvStreaming)
+{
+    std::string csv = "name,value,description\n";
+    for(int i = 0; i < 2500; i++)
+        csv += "item" + std::to_string(i) + "," + std::to_string(i) + ",\"quoted\n" + std::to_string(i) + "\"\n";
+    writeFile("_TempStream.csv", csv);
+
+    // small blocks, so records are split between them
+    CsvStreamReader reader{"_TempStream.csv", CsvReadOptions{}, 1000, 100};
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    while(auto batch = reader.readNext())
+        batches.push_back(batch);
+
+    BOOST_REQUIRE_EQUAL(batches.size(), 3);
+    BOOST_CHECK_EQUAL(batches[0]->num_rows(), 1000);
+    BOOST_CHECK_EQUAL(batches[1]->num_rows(), 1000);
+    BOOST_CHECK_EQUAL(batches[2]->num_rows(), 500);
+    BOOST_CHECK_EQUAL(reader.schema()->field(1)->type()->id(), arrow::Type::INT64);
+
+    std::shared_ptr<arrow::Table> streamedTable;
+    checkStatus(arrow::Table::FromRecordBatches(batches, &streamedTable));
+    const auto table = FormatCSV{}.readString(csv, CsvReadOptions{});
+    BOOST_REQUIRE_EQUAL(streamedTable->num_columns(), table->num_columns());
+    for(int i = 0; i < table->num_columns(); i++)
+        BOOST_CHECK(streamedTable->column(i)->data()->Equals(table->column(i)->data()));
+}
+
+BOOST_AUTO_TEST_CASE(ReadCsvMemoryMapped)
+{
+    // file filling whole pages, not terminated by a newline and ending with a number
+    std::string csv = "a,b\n";
+    while(csv.size() < 8192 - 8)
+        csv += "\"x\"\"y\",1\n";
+    csv.resize(8192 - 4, 'z');
+    csv += ",123";
+    BOOST_REQUIRE_EQUAL(csv.size(), 8192);
+    writeFile("_TempMapped.csv", csv);
+
+    CsvReadOptions options;
+    options.memoryMapping = true;
+    const auto mappedTable = FormatCSV{}.read("_TempMapped.csv", options);
+    options.memoryMapping = false;
+    const auto copiedTable = FormatCSV{}.read("_TempMapped.csv", options);
+    BOOST_CHECK(mappedTable->Equals(*copiedTable));
+
+    auto [strings, ints] = toVectors<std::string, int64_t>(*mappedTable);
+    BOOST_CHECK_EQUAL(strings.front(), "x\"y");
+    BOOST_CHECK_EQUAL(ints.back(), 123);
+
+    // parsing in place must not modify the file
+    BOOST_CHECK_EQUAL(getFileContents("_TempMapped.csv"), csv);
+}
+
+BOOST_AUTO_TEST_CASE(ReadColumnSelection)
+{
+    writeFile("_TempSelection.csv", "a,b,c\n1,x,1.5\n2,y,2.5\n3,z,\n");
+
+    CsvReadOptions options;
+    options.columns = { "c"s, 0 };
+    options.columnTypes = { ColumnType{ arrow::int64(), false, false } };
+    const auto table = FormatCSV{}.read("_TempSelection.csv", options);
+    BOOST_REQUIRE_EQUAL(table->num_columns(), 2);
+    BOOST_CHECK_EQUAL(table->column(0)->name(), "c");
+    BOOST_CHECK_EQUAL(table->column(1)->name(), "a");
+    BOOST_CHECK_EQUAL(table->column(0)->null_count(), 1);
+
+    auto [doubles, ints] = toVectors<std::optional<double>, int64_t>(*table);
+    BOOST_CHECK_EQUAL(*doubles.at(1), 2.5);
+    BOOST_CHECK_EQUAL_RANGES(ints, std::vector<int64_t>({ 1, 2, 3 }));
+
+    // streaming reader yields the same columns
+    CsvStreamReader reader{ "_TempSelection.csv", options, 2 };
+    BOOST_CHECK(reader.schema()->Equals(*table->schema()));
+
+    options.columns = { "d"s };
+    BOOST_CHECK_THROW(FormatCSV{}.read("_TempSelection.csv", options), std::exception);
+    options.columns = { 3 };
+    BOOST_CHECK_THROW(FormatCSV{}.read("_TempSelection.csv", options), std::exception);
+
+    // feather fetches only the selected columns
+    FormatFeather{}.write("_TempSelection.feather", *table);
+    FeatherReadOptions featherOptions;
+    featherOptions.columns = { "a"s };
+    const auto featherTable = FormatFeather{}.read("_TempSelection.feather", featherOptions);
+    BOOST_REQUIRE_EQUAL(featherTable->num_columns(), 1);
+    auto [featherInts] = toVectors<int64_t>(*featherTable);
+    BOOST_CHECK_EQUAL_RANGES(featherInts, ints);
+}
+
+BOOST_AUTO_TEST_CASE(ReadCsvWithPredicate)
+{
+    std::string csv = "a,b\n";
+    std::vector<std::string> expectedB;
+    for(int i = 0; i < 1000; i++)
+    {
+        csv += std::to_string(i) + ",b" + std::to_string(i) + "\n";
+        if(i % 7 == 0)
+            expectedB.push_back("b" + std::to_string(i));
+    }
+    writeFile("_TempPredicate.csv", csv);
+
+    // query: a%7 == 0
+    CsvReadOptions options;
+    options.predicate = R"({"predicate": "eq", "arguments": [{"operation": "mod", "arguments": [{"column": "a"}, 7]}, 0]})";
+    options.columns = { "b"s }; // predicate may refer to columns that are not selected
+    for(auto threadCount : { 1, 4 })
+    {
+        options.threadCount = threadCount;
+        const auto table = FormatCSV{}.read("_TempPredicate.csv", options);
+        BOOST_REQUIRE_EQUAL(table->num_columns(), 1);
+        auto [strings] = toVectors<std::string>(*table);
+        BOOST_CHECK_EQUAL_RANGES(strings, expectedB);
+    }
+
+    // batches with all rows filtered out are skipped
+    CsvStreamReader reader{ "_TempPredicate.csv", options, 5 };
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    while(auto batch = reader.readNext())
+    {
+        BOOST_CHECK_GT(batch->num_rows(), 0);
+        batches.push_back(batch);
+    }
+
+    std::shared_ptr<arrow::Table> streamedTable;
+    checkStatus(arrow::Table::FromRecordBatches(batches, &streamedTable));
+    auto [streamedB] = toVectors<std::string>(*streamedTable);
+    BOOST_CHECK_EQUAL_RANGES(streamedB, expectedB);
+}
+
+BOOST_AUTO_TEST_CASE(ReadCsvDictionaryEncoded)
+{
+    const std::vector<std::string> cityNames{ "Warsaw", "Cracow", "Gdansk" };
+    std::string csv = "city,id,name\n";
+    std::vector<std::string> expectedCities;
+    for(int i = 0; i < 1000; i++)
+    {
+        expectedCities.push_back(cityNames[i % 3]);
+        csv += expectedCities.back() + "," + std::to_string(i) + ",name" + std::to_string(i) + "\n";
+    }
+    writeFile("_TempDictionary.csv", csv);
+
+    CsvReadOptions options;
+    options.dictionaryEncoding = DictionaryEncoding::Automatic;
+    for(auto threadCount : { 1, 4 })
+    {
+        options.threadCount = threadCount;
+        const auto table = FormatCSV{}.read("_TempDictionary.csv", options);
+        BOOST_CHECK_EQUAL(table->column(0)->type()->id(), arrow::Type::DICTIONARY);
+        BOOST_CHECK_EQUAL(table->column(1)->type()->id(), arrow::Type::INT64);
+        BOOST_CHECK_EQUAL(table->column(2)->type()->id(), arrow::Type::STRING); // all values are distinct
+        const auto [cities, ids, names] = toVectors<std::string, int64_t, std::string>(*table);
+        BOOST_CHECK_EQUAL_RANGES(cities, expectedCities);
+
+        // filter keeps the codes
+        const auto filtered = filter(table, R"({"predicate": "eq", "arguments": [{"column": "city"}, "Gdansk"]})");
+        BOOST_CHECK_EQUAL(filtered->column(0)->type()->id(), arrow::Type::DICTIONARY);
+        BOOST_CHECK_EQUAL(filtered->num_rows(), 333);
+        const auto [filteredCities, filteredIds] = toVectors<std::string, int64_t>(*filtered);
+        BOOST_CHECK(std::all_of(filteredCities.begin(), filteredCities.end(), [] (auto &&city) { return city == "Gdansk"; }));
+        BOOST_CHECK_EQUAL(filteredIds.front(), 2);
+
+        // sort compares values, not codes
+        const auto sorted = sortTable(table, { table->column(0) });
+        BOOST_CHECK_EQUAL(sorted->column(0)->type()->id(), arrow::Type::DICTIONARY);
+        const auto [sortedCities, sortedIds] = toVectors<std::string, int64_t>(*sorted);
+        BOOST_CHECK(std::is_sorted(sortedCities.begin(), sortedCities.end()));
+        BOOST_CHECK_EQUAL(sortedIds.front(), 1); // first Cracow
+
+        const auto aggregated = abominableGroupAggregate(table->column(0), { { table->column(1), { AggregateFunction::Length } } });
+        const auto [groupCities, groupCounts] = toVectors<std::string, double>(*aggregated);
+        BOOST_CHECK_EQUAL_RANGES(groupCities, cityNames);
+        BOOST_CHECK_EQUAL_RANGES(groupCounts, (std::vector<double>{ 334, 333, 333 }));
+    }
+
+    options.dictionaryEncoding = DictionaryEncoding::Never;
+    const auto plainTable = FormatCSV{}.read("_TempDictionary.csv", options);
+    BOOST_CHECK_EQUAL(plainTable->column(0)->type()->id(), arrow::Type::STRING);
+}
+
+BOOST_AUTO_TEST_CASE(WriteCsvInParallel)
+{
+    // enough rows to be formatted in a few blocks
+    std::vector<int64_t> ints;
+    std::vector<std::optional<double>> doubles;
+    std::vector<std::optional<std::string>> strings;
+    std::vector<Timestamp> dates;
+    for(int i = 0; i < 50'000; i++)
+    {
+        ints.push_back(i % 2 ? i : -i);
+        doubles.push_back(i % 10 ? std::optional<double>(i / 8.0) : std::nullopt);
+        strings.push_back(i % 7 ? std::optional<std::string>(i % 3 ? "plain" + std::to_string(i) : "with, \"quotes\"") : std::nullopt);
+        dates.push_back(Timestamp(date::year_month_day{date::sys_days{2018_y/sep/1} + date::days{i % 1000}}));
+    }
+    const auto table = tableFromVectors(ints, doubles, strings, dates);
+
+    CsvWriteOptions options;
+    const auto singleThreaded = FormatCSV{}.writeToString(*table, options);
+    BOOST_CHECK_EQUAL(singleThreaded.substr(0, 64), "col0,col1,col2,col3\n0,,,2018-09-01\n1,0.125000,plain1,2018-09-02\n");
+
+    options.threadCount = 4;
+    const auto multiThreaded = FormatCSV{}.writeToString(*table, options);
+    BOOST_CHECK(singleThreaded == multiThreaded);
+
+    const auto readBack = FormatCSV{}.readString(multiThreaded, CsvReadOptions{});
+    const auto [readInts, readDoubles, readStrings, readDates] = toVectors<int64_t, std::optional<double>, std::optional<std::string>, Timestamp>(*readBack);
+    BOOST_CHECK_EQUAL_RANGES(readInts, ints);
+    BOOST_CHECK(readDoubles == doubles);
+    BOOST_CHECK(readStrings == strings);
+    BOOST_CHECK_EQUAL_RANGES(readDates, dates);
+
+    options.quotingPolicy = GeneratorQuotingPolicy::QueteAllFields;
+    const auto small = tableFromVectors(std::vector<int64_t>{-1}, std::vector<std::string>{"plain"});
+    const auto quoted = FormatCSV{}.writeToString(*small, options);
+    BOOST_CHECK_EQUAL(quoted, R"("col0","col1")" "\n" R"("-1","plain")");
+}
+
+BOOST_AUTO_TEST_CASE(ReadCompressedCsv)
+{
+    const auto plainPath = "data/samples/simple_plot.csv";
+    const auto plain = FormatCSV{}.read(plainPath);
+    for(std::string path : { "data/samples/simple_plot.csv.gz", "data/samples/simple_plot.csv.zst" })
+    {
+        BOOST_TEST_CONTEXT("Reading " << path)
+        {
+            const auto compression = detectCompression(path);
+            BOOST_CHECK(compression != Compression::None);
+            if(!isCompressionSupported(compression))
+            {
+                BOOST_TEST_MESSAGE("Skipping, " << compressionName(compression) << " is not supported by this build");
+                continue;
+            }
+
+            BOOST_CHECK_EQUAL(getDecompressedFileContents(path), getFileContents(plainPath));
+            BOOST_CHECK(readTableFromFile(path)->Equals(*plain));
+
+            // tiny segments make the file parsed in many chunks, while it is still being decompressed
+            const auto csv = parseCompressedCsvFile(path, ',', '\n', '"', 4, 64);
+            BOOST_CHECK_GT(csv.chunks.size(), 1);
+            const auto chunked = csvToArrowTable(csv, TakeFirstRowAsHeaders{}, {}, 50, 4);
+            BOOST_CHECK(chunked->Equals(*plain));
+
+            CsvStreamReader reader{ path, CsvReadOptions{}, 3 };
+            int64_t streamedRowCount = 0;
+            while(auto batch = reader.readNext())
+                streamedRowCount += batch->num_rows();
+            BOOST_CHECK_EQUAL(streamedRowCount, plain->num_rows());
+
+            const auto compressed = getFileContents(path);
+            const auto truncatedPath = "_TempTruncated" + path.substr(path.rfind('.'));
+            writeFile(truncatedPath, compressed.substr(0, compressed.size() / 2));
+            BOOST_CHECK_THROW(FormatCSV{}.read(truncatedPath), std::exception);
+        }
+    }
+
+    BOOST_CHECK(detectCompression(plainPath) == Compression::None);
+}
+
+BOOST_AUTO_TEST_CASE(ParseTimestamps)
+{
+    using namespace std::chrono;
+    const auto at = [] (date::year_month_day day, TimestampDuration timeOfDay)
+    {
+        return Timestamp{ Timestamp(day).toStorage() + timeOfDay.count() };
+    };
+
+    BOOST_CHECK_EQUAL(*parseTimestamp("2005-02-25"), Timestamp(2005_y/feb/25));
+    BOOST_CHECK_EQUAL(*parseTimestamp("1969-12-31"), Timestamp(1969_y/dec/31));
+    BOOST_CHECK_EQUAL(*parseTimestamp("2000-02-29"), Timestamp(2000_y/feb/29));
+    BOOST_CHECK_EQUAL(*parseTimestamp("2018-09-02T10:20:30"), at(2018_y/sep/2, 10h + 20min + 30s));
+    BOOST_CHECK_EQUAL(*parseTimestamp("2018-09-02T10:20:30.25Z"), at(2018_y/sep/2, 10h + 20min + 30s + 250ms));
+    BOOST_CHECK_EQUAL(*parseTimestamp("2018-09-02T00:00:00.123456789Z"), at(2018_y/sep/2, 123456789ns));
+
+    // formats other than the ISO one go through date library
+    BOOST_CHECK_EQUAL(*parseTimestamp("2005-2-5"), Timestamp(2005_y/feb/5));
+
+    for(auto text : { "", "2005", "123", "-1.5e-3", "2005-02-30", "1900-02-29", "2005-13-01", "2005-02-25T", "2005-02-25T24:00:00",
+        "2005-02-25T10:20", "2005-02-25T10:20:30.", "2005-02-25T10:20:30X", "2005-02-25 garbage" })
+    {
+        BOOST_TEST_CONTEXT("Parsing `" << text << "`")
+            BOOST_CHECK(!parseTimestamp(text));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(ParseFile)
 {
 	auto path = "data/samples/simple_empty.csv";
@@ -823,6 +1518,98 @@ BOOST_AUTO_TEST_CASE(TimestampParsingFromCsv)
     BOOST_CHECK(table->Equals(*tableXlsx));
 }
 
+BOOST_AUTO_TEST_CASE(ReadXlsxColumnsAndRowLimit)
+{
+    const auto ints = iotaVector<int64_t>(100);
+    const auto strings = transformToVector(ints, [] (int64_t i) { return "s" + std::to_string(i); });
+    const auto table = tableFromVectors(ints, strings, ints);
+    FormatXLSX{}.write("_TempReadXlsxColumns.xlsx", *table);
+
+    XlsxReadOptions options;
+    options.columnTypes = transformToVector(getColumns(*table), [] (auto col) { return ColumnType{ *col, false }; });
+    const auto wholeTable = FormatXLSX{}.read("_TempReadXlsxColumns.xlsx", options);
+    BOOST_CHECK(table->Equals(*wholeTable));
+
+    options.columns = { "col1"s, 0 };
+    options.rowLimit = 10;
+    const auto projected = FormatXLSX{}.read("_TempReadXlsxColumns.xlsx", options);
+    BOOST_REQUIRE_EQUAL(projected->num_columns(), 2);
+    BOOST_CHECK_EQUAL(projected->num_rows(), 10);
+    const auto [strings2, ints2] = toVectors<std::string, int64_t>(*projected);
+    BOOST_CHECK_EQUAL(strings2.back(), "s9");
+    BOOST_CHECK_EQUAL(ints2.back(), 9);
+
+    // without header row, the header cells become data
+    options.header = GenerateColumnNames{};
+    options.columnTypes = {};
+    options.columns = { 2 };
+    const auto withoutHeader = FormatXLSX{}.read("_TempReadXlsxColumns.xlsx", options);
+    BOOST_REQUIRE_EQUAL(withoutHeader->num_columns(), 1);
+    BOOST_CHECK_EQUAL(withoutHeader->column(0)->name(), "col2");
+    const auto [texts] = toVectors<std::string>(*withoutHeader);
+    BOOST_CHECK_EQUAL(texts.front(), "col2");
+    BOOST_CHECK_EQUAL(texts.back(), "8");
+
+    // generated names are known only when all cells were read
+    options.columns = { "col2"s, 0 };
+    const auto withoutHeaderByName = FormatXLSX{}.read("_TempReadXlsxColumns.xlsx", options);
+    BOOST_REQUIRE_EQUAL(withoutHeaderByName->num_columns(), 2);
+    BOOST_CHECK_EQUAL(withoutHeaderByName->column(0)->name(), "col2");
+    BOOST_CHECK_EQUAL(withoutHeaderByName->column(1)->name(), "col0");
+    const auto [texts2, firstTexts] = toVectors<std::string, std::string>(*withoutHeaderByName);
+    BOOST_CHECK_EQUAL_RANGES(texts2, texts);
+    BOOST_CHECK_EQUAL(firstTexts.front(), "col0");
+
+    options.columns = { "no such column"s };
+    BOOST_CHECK_THROW(FormatXLSX{}.read("_TempReadXlsxColumns.xlsx", options), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(ReadXlsxColumnBlankInLastRows)
+{
+    // null values are not written, so the last rows have cells only in the first column
+    const auto ints = iotaVector<int64_t>(10);
+    std::vector<std::optional<int64_t>> sparse{ 1, 2, 3, 4, 5, 6, 7, std::nullopt, std::nullopt, std::nullopt };
+    const auto table = tableFromVectors(ints, sparse);
+    FormatXLSX{}.write("_TempReadXlsxBlank.xlsx", *table);
+
+    XlsxReadOptions options;
+    options.columnTypes = transformToVector(getColumns(*table), [] (auto col) { return ColumnType{ *col, true }; });
+    const auto wholeTable = FormatXLSX{}.read("_TempReadXlsxBlank.xlsx", options);
+    BOOST_CHECK_EQUAL(wholeTable->num_rows(), 10);
+
+    options.columns = { "col1"s };
+    const auto projected = FormatXLSX{}.read("_TempReadXlsxBlank.xlsx", options);
+    BOOST_REQUIRE_EQUAL(projected->num_columns(), 1);
+    BOOST_CHECK_EQUAL(projected->num_rows(), wholeTable->num_rows());
+    BOOST_CHECK_EQUAL(projected->column(0)->null_count(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(DetectFileFormatFromHeader)
+{
+    const auto plainHeader = FileHeader::read("data/samples/simple_plot.csv");
+    BOOST_CHECK(plainHeader.compression == Compression::None);
+    BOOST_CHECK_EQUAL(plainHeader.bytes.size(), FileHeader::maxLength);
+
+    const auto compressedHeader = FileHeader::read("data/samples/simple_plot.csv.gz");
+    BOOST_CHECK(compressedHeader.compression == Compression::Gzip);
+    BOOST_CHECK_EQUAL(compressedHeader.bytes, plainHeader.bytes);
+    BOOST_CHECK_EQUAL(FormatFeather{}.compatibilityScore("data/samples/simple_plot.csv.gz", compressedHeader), 0);
+    BOOST_CHECK_GT(FormatCSV{}.compatibilityScore("data/samples/simple_plot.csv.gz", compressedHeader), 0);
+
+    // signature outweighs misleading extension
+    std::vector<int64_t> ints{ 50, 100 };
+    const auto table = tableFromVectors(ints);
+    const auto path = "_TempDetectFileFormat.csv";
+    FormatArrowIPC{}.write(path, *table);
+    const auto header = FileHeader::read(path);
+    BOOST_CHECK_GT(FormatArrowIPC{}.compatibilityScore(path, header), FormatCSV{}.compatibilityScore(path, header));
+    BOOST_CHECK_EQUAL(FormatFeather{}.compatibilityScore(path, header), 0);
+    const auto readTable = readTableFromFile(path);
+    BOOST_CHECK(readTable->Equals(*table));
+
+    BOOST_CHECK_THROW(FileHeader::read("_TempNoSuchFile.csv"), CannotOpenToRead);
+}
+
 BOOST_AUTO_TEST_CASE(ReadTableDeducingFileType)
 {
     std::vector<int64_t> ints{50,100};
@@ -858,6 +1645,333 @@ BOOST_AUTO_TEST_CASE(ReadTableDeducingFileType)
     BOOST_CHECK_EQUAL_RANGES(strings, ints4);
 }
 
+BOOST_AUTO_TEST_CASE(ReadTablesFromManyFiles)
+{
+    // the second partition would have its type deduced differently on its own
+    writeFile("_TempPartition-01.csv", "day,value,note\n1,10,a\n2,20,b\n");
+    writeFile("_TempPartition-02.csv", "day,value,note\n3,,\n");
+    writeFile("_TempPartition-03.csv", "day,value,note\n4,40,c\n5,50,\n6,60,d\n");
+    writeFile("_TempPartitionMismatch.csv", "day,amount,note\n7,70,e\n");
+
+    const auto paths = expandFilePattern("_TempPartition-??.csv");
+    BOOST_CHECK_EQUAL_RANGES(paths, (std::vector<std::string>{ "_TempPartition-01.csv", "_TempPartition-02.csv", "_TempPartition-03.csv" }));
+    const auto pathsInDirectory = expandFilePattern("./_TempPartition-*");
+    BOOST_CHECK_EQUAL_RANGES(pathsInDirectory, (std::vector<std::string>{ "./_TempPartition-01.csv", "./_TempPartition-02.csv", "./_TempPartition-03.csv" }));
+    BOOST_CHECK(expandFilePattern("_TempPartition-*.xlsx").empty());
+
+    for(int threadCount : { 1, 4 })
+    {
+        const auto table = readTablesFromFiles("_TempPartition-*.csv", threadCount);
+        BOOST_REQUIRE_EQUAL(table->num_columns(), 3);
+        BOOST_CHECK_EQUAL(table->num_rows(), 6);
+        BOOST_CHECK_EQUAL(table->column(0)->data()->num_chunks(), 3);
+        BOOST_CHECK(table->column(1)->field()->nullable());
+
+        const auto [days, values, notes] = toVectors<int64_t, std::optional<int64_t>, std::optional<std::string>>(*table);
+        BOOST_CHECK_EQUAL_RANGES(days, (std::vector<int64_t>{ 1, 2, 3, 4, 5, 6 }));
+        BOOST_CHECK(values == (std::vector<std::optional<int64_t>>{ 10, 20, std::nullopt, 40, 50, 60 }));
+        BOOST_CHECK(notes == (std::vector<std::optional<std::string>>{ "a"s, "b"s, std::nullopt, "c"s, std::nullopt, "d"s }));
+    }
+
+    BOOST_CHECK_THROW(readTablesFromFiles(std::vector<std::string>{ "_TempPartition-01.csv", "_TempPartitionMismatch.csv" }), std::exception);
+    BOOST_CHECK_THROW(readTablesFromFiles("_TempNoSuchPartition-*.csv"), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(LoadTableAsynchronously)
+{
+    // enough rows for the parser to report progress several times
+    const auto ints = iotaVector<int64_t>(20'000);
+    const auto table = tableFromVectors(ints);
+    const auto path = "_TempLoadTableAsynchronously.csv";
+    FormatCSV{}.write(path, *table);
+
+    const auto job = readTableFromFileAsync(path);
+    BOOST_REQUIRE(job->wait(std::chrono::seconds(30)));
+    BOOST_CHECK(job->state() == LoadJobState::Finished);
+    BOOST_CHECK(job->result()->Equals(*table));
+    BOOST_CHECK_EQUAL(job->progress().bytesTotal, (int64_t)getFileContents(path).size());
+    BOOST_CHECK_EQUAL(job->progress().bytesRead, job->progress().bytesTotal);
+    BOOST_CHECK_EQUAL(job->progress().rowsParsed, 20'000);
+
+    CsvReadOptions options;
+    options.header = GenerateColumnNames{};
+    const auto csvJob = readTableFromCSVFileAsync(path, options);
+    BOOST_CHECK_EQUAL(csvJob->result()->num_rows(), 20'001);
+    BOOST_CHECK_EQUAL(csvJob->progress().rowsParsed, 20'001);
+
+    // header line is parsed as well, but it is not a row of the table
+    const auto csvJobWithHeader = readTableFromCSVFileAsync(path, CsvReadOptions{});
+    BOOST_CHECK_EQUAL(csvJobWithHeader->result()->num_rows(), 20'000);
+    BOOST_CHECK_EQUAL(csvJobWithHeader->progress().rowsParsed, 20'000);
+
+    const auto failingJob = readTableFromFileAsync("_TempNoSuchFile.csv");
+    BOOST_CHECK_THROW(failingJob->result(), CannotOpenToRead);
+    BOOST_CHECK(failingJob->state() == LoadJobState::Failed);
+
+    // loader that runs until it is cancelled
+    const auto endlessJob = LoadJob::start([] (LoadProgress &progress) -> std::shared_ptr<arrow::Table>
+    {
+        while(true)
+        {
+            progress.throwIfCancelled();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    BOOST_CHECK(!endlessJob->wait(std::chrono::milliseconds(50)));
+    endlessJob->cancel();
+    BOOST_REQUIRE(endlessJob->wait(std::chrono::seconds(30)));
+    BOOST_CHECK(endlessJob->state() == LoadJobState::Cancelled);
+    BOOST_CHECK_THROW(endlessJob->result(), LoadCancelled);
+}
+
+BOOST_AUTO_TEST_CASE(ReadCsvThroughCache)
+{
+    const auto directory = "_TempCsvCache";
+    boost::filesystem::remove_all(directory);
+
+    const auto path = "_TempReadCsvThroughCache.csv";
+    writeFile(path, "a,b\n1,x\n2,y\n3,\n");
+    const auto expected = FormatCSV{}.read(path);
+
+    CsvCache::enable(directory, 1 << 20);
+    const auto cache = CsvCache::active();
+    BOOST_REQUIRE(cache);
+
+    BOOST_CHECK(FormatCSV{}.read(path)->Equals(*expected));
+    BOOST_CHECK_EQUAL(cache->misses(), 1);
+    BOOST_CHECK(readTableFromFile(path)->Equals(*expected));
+    BOOST_CHECK(FormatCSV{}.read(path)->Equals(*expected));
+    BOOST_CHECK_EQUAL(cache->hits(), 2);
+    const auto entrySize = cache->cachedBytes();
+    BOOST_CHECK_GT(entrySize, 0);
+
+    // options affecting the result make a separate entry, thread count does not
+    CsvReadOptions options;
+    options.threadCount = 4;
+    FormatCSV{}.read(path, options);
+    BOOST_CHECK_EQUAL(cache->hits(), 3);
+    options.columns = { "b"s };
+    BOOST_CHECK_EQUAL(FormatCSV{}.read(path, options)->num_columns(), 1);
+    BOOST_CHECK_EQUAL(cache->misses(), 2);
+
+    // changed file is parsed again
+    writeFile(path, "a,b\n1,x\n");
+    BOOST_CHECK_EQUAL(FormatCSV{}.read(path)->num_rows(), 1);
+    BOOST_CHECK_EQUAL(cache->misses(), 3);
+
+    // limit fitting a single entry makes storing evict the others
+    CsvCache::enable(directory, entrySize + entrySize / 2);
+    writeFile(path, "a,b\n1,x\n2,y\n");
+    FormatCSV{}.read(path);
+    BOOST_CHECK_LE(CsvCache::active()->cachedBytes(), entrySize + entrySize / 2);
+    BOOST_CHECK_EQUAL(CsvCache::active()->hits(), 0);
+
+    CsvCache::disable();
+    BOOST_CHECK(!CsvCache::active());
+    BOOST_CHECK_THROW(CsvCache::enable(directory, 0), std::exception);
+    boost::filesystem::remove_all(directory);
+}
+
+BOOST_AUTO_TEST_CASE(ReadWriteJsonLines)
+{
+    const auto data =
+        R"({"id": 1, "name": "a", "score": 1.5, "when": "2018-09-01", "tags": ["x"]})" "\n"
+        R"({"id": 2, "score": 2, "name": null, "when": "2018-09-02", "extra": true})" "\n"
+        "\n"
+        R"({"name": "c\"q\"", "id": 3, "score": "n/a"})" "\n";
+
+    for(int threadCount : { 1, 4 })
+    {
+        JsonlReadOptions options;
+        options.threadCount = threadCount;
+        options.typeDeductionDepth = 2; // so "n/a" does not make scores a text column
+        const auto table = FormatJSONL{}.readString(data, options);
+        BOOST_REQUIRE_EQUAL(table->num_columns(), 6);
+        BOOST_CHECK_EQUAL(table->num_rows(), 3);
+        BOOST_CHECK_EQUAL(table->column(0)->type()->id(), arrow::Type::INT64);
+        BOOST_CHECK_EQUAL(table->column(2)->type()->id(), arrow::Type::DOUBLE);
+        BOOST_CHECK_EQUAL(table->column(3)->type()->id(), arrow::Type::TIMESTAMP);
+        BOOST_CHECK_EQUAL(table->column(4)->name(), "tags");
+        BOOST_CHECK_EQUAL(table->column(4)->null_count(), 3); // nested values are not supported
+
+        const auto [ids, names, scores] = toVectors<int64_t, std::optional<std::string>, std::optional<double>>(*table);
+        BOOST_CHECK_EQUAL_RANGES(ids, (std::vector<int64_t>{ 1, 2, 3 }));
+        BOOST_CHECK(names == (std::vector<std::optional<std::string>>{ "a"s, std::nullopt, "c\"q\""s }));
+        BOOST_CHECK(scores == (std::vector<std::optional<double>>{ 1.5, 2.0, std::nullopt }));
+        const auto extras = toVector<std::optional<int64_t>>(*table->column(5));
+        BOOST_CHECK(extras == (std::vector<std::optional<int64_t>>{ std::nullopt, 1, std::nullopt }));
+    }
+
+    // keys appearing only after the deduction depth are ignored
+    JsonlReadOptions options;
+    options.typeDeductionDepth = 1;
+    options.columns = { "name"s, "id"s };
+    const auto projected = FormatJSONL{}.readString(data, options);
+    BOOST_REQUIRE_EQUAL(projected->num_columns(), 2);
+    BOOST_CHECK_EQUAL(projected->column(0)->name(), "name");
+    options.columns = { "extra"s };
+    BOOST_CHECK_THROW(FormatJSONL{}.readString(data, options), std::exception);
+
+    BOOST_CHECK_THROW(FormatJSONL{}.readString("{\"a\": 1}\n[1, 2]\n", {}), std::exception);
+    BOOST_CHECK_THROW(FormatJSONL{}.readString("{\"a\": 1}\n{\"a\": \n", {}), std::exception);
+
+    // written records read back the same
+    options = {};
+    options.typeDeductionDepth = 2;
+    const auto table = FormatJSONL{}.readString(data, options);
+    const auto written = FormatJSONL{}.writeToString(*table, {});
+    BOOST_CHECK_EQUAL(written.substr(0, written.find('\n')), R"({"id":1,"name":"a","score":1.5,"when":"2018-09-01T00:00:00"})");
+    const auto readBack = FormatJSONL{}.readString(written, {});
+    BOOST_REQUIRE_EQUAL(readBack->num_columns(), 5); // column with nulls only is not written
+    for(int i = 0; i < 4; i++)
+        BOOST_CHECK(readBack->column(i)->data()->Equals(table->column(i)->data()));
+
+    // time of day is kept, fraction of second is written only when needed
+    const date::sys_days day = 2018_y / sep / 01;
+    const auto timestamps = std::vector<Timestamp>{ day + 1h + 2min + 3s, day + 4s + 5ms, day + 6s + 7ns };
+    const auto timestampTable = tableFromVectors(timestamps);
+    const auto writtenTimestamps = FormatJSONL{}.writeToString(*timestampTable, {});
+    BOOST_CHECK_EQUAL(writtenTimestamps.substr(0, writtenTimestamps.find('\n')), R"({"col0":"2018-09-01T01:02:03"})");
+    BOOST_CHECK_NE(writtenTimestamps.find(R"("2018-09-01T00:00:04.005")"), std::string::npos);
+    BOOST_CHECK_NE(writtenTimestamps.find(R"("2018-09-01T00:00:06.000000007")"), std::string::npos);
+    const auto [timestampsReadBack] = toVectors<Timestamp>(*FormatJSONL{}.readString(writtenTimestamps, {}));
+    BOOST_CHECK_EQUAL_RANGES(timestampsReadBack, timestamps);
+}
+
+BOOST_AUTO_TEST_CASE(ReadFeatherLazily)
+{
+    const auto ints = iotaVector<int64_t>(1000);
+    const auto doubles = transformToVector(ints, [] (int64_t i) { return i / 4.0; });
+    const auto table = tableFromVectors(ints, doubles, ints);
+
+    const auto path = "_TempReadFeatherLazily.feather";
+    FormatFeather{}.write(path, *table);
+
+    FeatherReadOptions options;
+    options.lazy = true;
+    const auto readTable = FormatFeather{}.read(path, options);
+    const auto lazyTable = std::dynamic_pointer_cast<LazyTable>(readTable);
+    BOOST_REQUIRE(lazyTable);
+    BOOST_CHECK_EQUAL(lazyTable->num_columns(), 3);
+    BOOST_CHECK_EQUAL(lazyTable->num_rows(), 1000);
+    BOOST_CHECK_EQUAL(lazyTable->schema()->field(1)->type()->id(), arrow::Type::DOUBLE);
+    BOOST_CHECK(lazyTable->loadedColumns().empty());
+
+    const auto doublesColumn = lazyTable->column(1);
+    const auto [doubles2] = toVectors<double>(*tableFromColumns({ doublesColumn }));
+    BOOST_CHECK_EQUAL_RANGES(doubles, doubles2);
+    const auto loadedAfterFirst = lazyTable->loadedColumns();
+    BOOST_CHECK_EQUAL_RANGES(loadedAfterFirst, (std::vector<int>{ 1 }));
+
+    // loading other columns does not change the ones handed out, so they can be found by identity
+    lazyTable->column(2);
+    const auto loadedAfterSecond = lazyTable->loadedColumns();
+    BOOST_CHECK_EQUAL_RANGES(loadedAfterSecond, (std::vector<int>{ 1, 2 }));
+    BOOST_CHECK_EQUAL(lazyTable->column(1), doublesColumn);
+    const auto replaced = replaceColumn(*readTable, *doublesColumn, toColumn(ints, "col1"));
+    BOOST_CHECK(replaced->column(1)->data()->Equals(table->column(0)->data()));
+
+    // operations work on lazy tables as on any other
+    for(int i = 0; i < table->num_columns(); i++)
+        BOOST_CHECK(readTable->column(i)->data()->Equals(table->column(i)->data()));
+    const auto filtered = filter(readTable, R"({"predicate": "lt", "arguments": [{"column": "col0"}, 10]})");
+    BOOST_CHECK_EQUAL(filtered->num_rows(), 10);
+    BOOST_CHECK_THROW(lazyTable->column(3), std::exception);
+
+    options.columns = { "col2"s };
+    const auto projected = FormatFeather{}.read(path, options);
+    BOOST_REQUIRE_EQUAL(projected->num_columns(), 1);
+    BOOST_CHECK(projected->column(0)->data()->Equals(table->column(2)->data()));
+}
+
+BOOST_AUTO_TEST_CASE(ReadWriteArrowIPC)
+{
+    std::vector<int64_t> ints{ 1, 2, 3 };
+    std::vector<std::optional<std::string>> strings{ "one"s, std::nullopt, "three"s };
+    const auto part = tableFromVectors(ints, strings);
+    const auto table = concatenateTables({ part, part });
+
+    const auto path = "_TempReadWriteArrowIPC.arrow";
+    FormatArrowIPC{}.write(path, *table);
+    BOOST_CHECK(FormatArrowIPC{}.fileMightBeCompatible(path));
+
+    const auto readTable = readTableFromFile(path);
+    BOOST_CHECK(readTable->Equals(*table));
+    BOOST_CHECK_EQUAL(readTable->column(0)->data()->num_chunks(), 2);
+
+    ArrowIPCReadOptions options;
+    options.columns = { "col1"s };
+    const auto projected = FormatArrowIPC{}.read(path, options);
+    BOOST_REQUIRE_EQUAL(projected->num_columns(), 1);
+    const auto [strings2] = toVectors<std::optional<std::string>>(*projected);
+    BOOST_CHECK(strings2 == (std::vector<std::optional<std::string>>{ "one"s, std::nullopt, "three"s, "one"s, std::nullopt, "three"s }));
+}
+
+BOOST_AUTO_TEST_CASE(ReadWriteParquet)
+{
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+    std::vector<std::optional<std::string>> strings;
+    for(int i = 0; i < 1000; i++)
+    {
+        ints.push_back(i);
+        doubles.push_back(i / 2.0);
+        strings.push_back(i % 7 ? std::optional<std::string>(std::to_string(i)) : std::nullopt);
+    }
+    const auto table = tableFromVectors(ints, doubles, strings);
+
+    const auto path = "_TempReadWriteParquet.parquet";
+    ParquetWriteOptions writeOptions;
+    writeOptions.rowGroupSize = 100;
+    writeOptions.compression = ParquetCompression::None;
+    FormatParquet{}.write(path, *table, writeOptions);
+
+    const auto wholeTable = readTableFromFile(path);
+    BOOST_CHECK_EQUAL(wholeTable->column(0)->data()->num_chunks(), 10);
+    const auto [ints2, doubles2, strings2] = toVectors<int64_t, double, std::optional<std::string>>(*wholeTable);
+    BOOST_CHECK_EQUAL_RANGES(ints, ints2);
+    BOOST_CHECK_EQUAL_RANGES(doubles, doubles2);
+    BOOST_CHECK(strings == strings2);
+
+    ParquetReadOptions readOptions;
+    readOptions.columns = { "col2"s, 0 };
+    readOptions.rowGroups = { 3, 1 };
+    const auto projected = FormatParquet{}.read(path, readOptions);
+    BOOST_REQUIRE_EQUAL(projected->num_columns(), 2);
+    BOOST_CHECK_EQUAL(projected->column(0)->name(), "col2");
+    const auto [strings3, ints3] = toVectors<std::optional<std::string>, int64_t>(*projected);
+    BOOST_CHECK_EQUAL(ints3.front(), 300);
+    BOOST_CHECK_EQUAL(ints3.back(), 199);
+    BOOST_CHECK(strings3.front() == std::nullopt); // 300 is divisible by 7
+    BOOST_CHECK(strings3.back() == "199"s);
+
+    // row groups [200, 300) and [300, 400) are the only ones that may contain matching rows
+    readOptions = {};
+    readOptions.columns = { "col1"s };
+    readOptions.predicate = R"({"boolean": "and", "arguments": [ {"predicate": "gt", "arguments": [ {"column": "col0"}, 250 ] }, {"predicate": "lt", "arguments": [ {"column": "col0"}, 350 ] } ] })";
+    const auto rowGroups = FormatParquet{}.rowGroupsToRead(path, readOptions);
+    BOOST_CHECK_EQUAL_RANGES(rowGroups, (std::vector<int>{ 2, 3 }));
+    for(int threadCount : { 1, 4 })
+    {
+        readOptions.threadCount = threadCount;
+        const auto filtered = FormatParquet{}.read(path, readOptions);
+        BOOST_REQUIRE_EQUAL(filtered->num_columns(), 1);
+        const auto [doubles4] = toVectors<double>(*filtered);
+        BOOST_REQUIRE_EQUAL(doubles4.size(), 99);
+        BOOST_CHECK_EQUAL(doubles4.front(), 125.5);
+        BOOST_CHECK_EQUAL(doubles4.back(), 174.5);
+    }
+
+    readOptions.predicate = R"({"predicate": "eq", "arguments": [ {"column": "col0"}, 5000 ] })";
+    BOOST_CHECK(FormatParquet{}.rowGroupsToRead(path, readOptions).empty());
+    const auto empty = FormatParquet{}.read(path, readOptions);
+    BOOST_CHECK_EQUAL(empty->num_columns(), 1);
+    BOOST_CHECK_EQUAL(empty->num_rows(), 0);
+
+    readOptions.rowGroups = { 10 };
+    BOOST_CHECK_THROW(FormatParquet{}.read(path, readOptions), std::exception);
+}
+
 BOOST_AUTO_TEST_CASE(WriteTableDeducingFileType)
 {
     std::vector<int64_t> ints{ 50,100 };
@@ -881,6 +1995,9 @@ BOOST_AUTO_TEST_CASE(WriteTableDeducingFileType)
     testRoundTrip("txt", FormatCSV{});
     testRoundTrip("xlsx", FormatXLSX{});
     testRoundTrip("feather", FormatFeather{});
+    testRoundTrip("parquet", FormatParquet{});
+    testRoundTrip("arrow", FormatArrowIPC{});
+    testRoundTrip("jsonl", FormatJSONL{});
     BOOST_CHECK_THROW(writeTableToFile("WriteTableDeducingFileType.7z", *table), std::exception); // not a valid extension
 }
 